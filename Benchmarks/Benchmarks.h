@@ -0,0 +1,122 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _GAMESTRAP_MODERNDIALOGS_BENCHMARKS_H_
+#define _GAMESTRAP_MODERNDIALOGS_BENCHMARKS_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Summary of a set of timing samples in milliseconds.
+	/// </summary>
+	struct Statistics
+	{
+		double Min = 0.0;
+		double Mean = 0.0;
+		double P50 = 0.0;
+		double P90 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+	/// <summary>
+	/// Compute statistics for the given samples.
+	/// </summary>
+	/// <param name="samples">Samples in milliseconds.</param>
+	/// <returns>Statistics of the samples.</returns>
+	Statistics Summarize(std::vector<double> samples);
+
+	/// <summary>
+	/// Print a single result line.
+	/// </summary>
+	/// <param name="name">Name of the measurement.</param>
+	/// <param name="samples">Samples in milliseconds.</param>
+	void Report(std::string_view name, const std::vector<double>& samples);
+
+	/// <summary>
+	/// Measure the given function once.
+	/// </summary>
+	/// <param name="func">Function to measure.</param>
+	/// <returns>Elapsed time in milliseconds.</returns>
+	double Measure(const std::function<void()>& func);
+
+	/// <summary>
+	/// Run func in a freshly forked child process so that every sample starts with cold library state.<br>
+	/// Returns an empty vector on platforms without fork().
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="func">Function to measure inside the child process.</param>
+	/// <returns>Samples in milliseconds.</returns>
+	std::vector<double> MeasureCold(uint32_t samples, const std::function<void()>& func);
+
+	/// <summary>
+	/// Run setup and then func in a freshly forked child process, only func is measured.
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="setup">Function to run before the measurement.</param>
+	/// <param name="func">Function to measure inside the child process.</param>
+	/// <returns>Samples in milliseconds.</returns>
+	std::vector<double> MeasureCold(uint32_t samples, const std::function<void()>& setup, const std::function<void()>& func);
+
+	/// <summary>
+	/// Run setup and then func in a freshly forked child process and collect the values returned by func.
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="setup">Function to run before taking the sample.</param>
+	/// <param name="func">Function returning the sample inside the child process.</param>
+	/// <returns>Samples returned by func.</returns>
+	std::vector<double> SampleCold(uint32_t samples, const std::function<void()>& setup, const std::function<double()>& func);
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	//Each backend has a directory with its stubs below MD_BENCHMARK_STUBS_DIR, which becomes the only entry on PATH
+	inline constexpr std::array<const char*, 7> StubBackends
+	{
+		"kdialog", "zenity", "matedialog", "shellementary", "qarma", "yad", "tkinter"
+	};
+
+	/// <summary>
+	/// Make the stubs of the given backend the only executables the library can find.
+	/// </summary>
+	/// <param name="backend">Name of the backend, one of StubBackends.</param>
+	void UseStubBackend(const char* backend);
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void RunDetectionBenchmark(uint32_t samples);
+	void RunConcurrencyBenchmark(uint32_t samples);
+	void RunParsingBenchmark(uint32_t samples);
+	void RunEscapingBenchmark(uint32_t samples);
+	void RunUnicodeBenchmark(uint32_t samples);
+	void RunEndToEndBenchmark(uint32_t samples);
+}
+
+#endif /*_GAMESTRAP_MODERNDIALOGS_BENCHMARKS_H_*/
@@ -0,0 +1,101 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <ModernDialogs.h>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	constexpr uint32_t ThreadCount = 16;
+	constexpr uint32_t CallsPerThread = 8;
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Fire dialogs from many threads at once while the backend detection is still cold.<br>
+	/// The zenity stubs answer every dialog, so detection, spawning and parsing all run concurrently.
+	/// The ConcurrencyTest project runs the same mix with ThreadSanitizer.
+	/// </summary>
+	void ConcurrentDialogs()
+	{
+		Benchmarks::UseStubBackend("zenity");
+
+		std::atomic<bool> start = false;
+		std::vector<std::thread> threads{};
+		threads.reserve(ThreadCount);
+
+		for(uint32_t i = 0; i < ThreadCount; ++i)
+		{
+			threads.emplace_back([&start, i]()
+			{
+				while(!start)
+					std::this_thread::yield();
+
+				for(uint32_t j = 0; j < CallsPerThread; ++j)
+				{
+					switch((i + j) % 4)
+					{
+					case 0:
+						static_cast<void>(MD::ShowMsgBox("Title", "Message", MD::Style::Info, MD::Buttons::OKCancel));
+						break;
+
+					case 1:
+						static_cast<void>(MD::OpenFile("Title", "", {{"Text", "*.txt"}}, true));
+						break;
+
+					case 2:
+						static_cast<void>(MD::SaveFile("Title", "File.txt"));
+						break;
+
+					default:
+						MD::Prewarm();
+						static_cast<void>(MD::SelectFolder("Title"));
+						break;
+					}
+				}
+			});
+		}
+
+		start = true;
+		for(std::thread& thread : threads)
+			thread.join();
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::RunConcurrencyBenchmark(const uint32_t samples)
+{
+	std::cout << "Concurrent dialog calls (" << ThreadCount << " threads x " << CallsPerThread << " calls)\n";
+
+	Report("  cold library state", MeasureCold(samples, ConcurrentDialogs));
+
+	std::cout << '\n';
+}
@@ -0,0 +1,154 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <ModernDialogs.h>
+#include <ModernDialogsDetail.h>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	//Same executables the library looks for
+	constexpr std::array<const char*, 19> ProbedExecutables
+	{
+		"kdialog", "zenity", "matedialog", "shellementary", "qarma", "yad", "xprop",
+		"python3", "python3.10", "python3.9", "python3.8", "python3.7", "python3.6",
+		"python3.5", "python3.4", "python3.3", "python3.2", "python3.1", "python3.0"
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Reference implementation of the old executable lookup: one "command -v" shell per executable.
+	/// </summary>
+	void LegacyShellDetection()
+	{
+#ifdef __linux__
+		for(const char* const executable : ProbedExecutables)
+		{
+			const std::string cmd = std::string("command -v ") + executable + " 2>/dev/null";
+			FILE* const in = popen(cmd.c_str(), "r");
+			if(in == nullptr)
+				continue;
+
+			std::array<char, 128> buffer{};
+			while(fgets(buffer.data(), buffer.size(), in) != nullptr)
+				;
+			pclose(in);
+		}
+#endif
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Executable lookup of the library, resolves the same executables as LegacyShellDetection().
+	/// </summary>
+	void LibraryPATHScan()
+	{
+		static_cast<void>(MD::Detail::ResolveExecutables());
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Cold detection through the public API, this includes the version probes of the backends and the tkinter import.<br>
+	/// Uses a display which doesn't exist, so backends get detected but no dialog can open.
+	/// </summary>
+	void LibraryDetection()
+	{
+#ifdef __linux__
+		setenv("DISPLAY", ":ModernDialogsBenchmark", 1);
+		unsetenv("WAYLAND_DISPLAY");
+#endif
+		MD::Prewarm();
+		MD::WaitForPrewarm();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Cold detection with the persistent detection cache stored in a private directory.
+	/// </summary>
+	void CachedLibraryDetection()
+	{
+#ifdef __linux__
+		//Samples run in forked children, key the directory on the benchmark process
+		const std::string cacheDir = "/tmp/ModernDialogsBenchmarkCache." + std::to_string(getppid());
+		setenv("XDG_CACHE_HOME", cacheDir.c_str(), 1);
+#endif
+		MD::SetDetectionCacheEnabled(true);
+		LibraryDetection();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Worst case for detection: nothing can be found, so every candidate gets probed.
+	/// </summary>
+	void UseEmptyPATH()
+	{
+#ifdef __linux__
+		setenv("PATH", "/nonexistent/bin:/nonexistent/usr/bin", 1);
+#endif
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::RunDetectionBenchmark(const uint32_t samples)
+{
+	//The old detection only differed in how executables were found, so that is what gets compared
+	std::cout << "Cold executable lookup (" << ProbedExecutables.size() << " executables)\n";
+
+	Report("  shell probes (command -v per executable)", MeasureCold(samples, LegacyShellDetection));
+	Report("  in-process PATH scan", MeasureCold(samples, LibraryPATHScan));
+	Report("  shell probes (nothing on PATH)", MeasureCold(samples, []{ UseEmptyPATH(); LegacyShellDetection(); }));
+	Report("  in-process PATH scan (nothing on PATH)", MeasureCold(samples, []{ UseEmptyPATH(); LibraryPATHScan(); }));
+
+	std::cout << "\nCold backend detection (executable lookup, version probes and tkinter import)\n";
+
+	Report("  ModernDialogs detection", MeasureCold(samples, LibraryDetection));
+	MeasureCold(1, CachedLibraryDetection); //Populate the cache
+	Report("  ModernDialogs detection (warm detection cache)", MeasureCold(samples, CachedLibraryDetection));
+	Report("  ModernDialogs detection (nothing on PATH)", MeasureCold(samples, []{ UseEmptyPATH(); LibraryDetection(); }));
+
+#ifdef __linux__
+	std::error_code ec{};
+	std::filesystem::remove_all("/tmp/ModernDialogsBenchmarkCache." + std::to_string(getpid()), ec);
+#endif
+
+	std::cout << '\n';
+}
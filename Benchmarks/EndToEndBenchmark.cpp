@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <ModernDialogs.h>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	struct DialogOperation
+	{
+		const char* Name;
+		//Returns whether the dialog produced the canned result
+		bool(*Run)();
+	};
+
+	constexpr std::array<DialogOperation, 4> DialogOperations
+	{
+		{
+			{"SaveFile", []{ return !MD::SaveFile("Title", "File.txt", {{"Text", "*.txt"}}).empty(); }},
+			{"OpenFile", []{ return !MD::OpenFile("Title", "", {{"Text", "*.txt"}}).empty(); }},
+			{"SelectFolder", []{ return !MD::SelectFolder("Title").empty(); }},
+			{"ShowMsgBox", []{ return MD::ShowMsgBox("Title", "Message", MD::Style::Info, MD::Buttons::OK) == MD::Selection::OK; }}
+		}
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Run the operation, a failed dialog exits the child process so it doesn't produce a sample.
+	/// </summary>
+	void RunOrExit(const DialogOperation& operation)
+	{
+		if(!operation.Run())
+			std::_Exit(1);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] std::string_view GetPhaseName(const MD::TracePhase phase)
+	{
+		switch(phase)
+		{
+		case MD::TracePhase::Detection:
+			return "detection";
+		case MD::TracePhase::CommandBuild:
+			return "command build";
+		case MD::TracePhase::Spawn:
+			return "spawn";
+		case MD::TracePhase::Run:
+			return "run";
+		case MD::TracePhase::Parse:
+			return "parse";
+		case MD::TracePhase::Validate:
+			return "validate";
+		}
+
+		return "unknown";
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void PrintTraceEvent(const MD::TraceEvent& event)
+	{
+		const std::string name = std::string(GetPhaseName(event.Phase)) + (event.Detail.empty() ? "" : " (" + std::string(event.Detail) + ')');
+
+		std::cout << "    " << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(3)
+		          << std::setw(9) << std::chrono::duration<double, std::milli>(event.End - event.Start).count() << " ms\n";
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::RunEndToEndBenchmark(const uint32_t samples)
+{
+	std::cout << "End-to-end dialog round trip with stub backends (no samples = wrong result)\n";
+
+	for(const char* const backend : StubBackends)
+	{
+		for(const DialogOperation& operation : DialogOperations)
+		{
+			const std::string name = std::string("  ") + backend + ' ' + operation.Name;
+
+			//Cold includes backend detection, warm only command build, spawn, read, parse and validate
+			Report(name + " (cold)", MeasureCold(samples, [backend]{ UseStubBackend(backend); },
+			                                     [&operation]{ RunOrExit(operation); }));
+			Report(name + " (warm)", MeasureCold(samples, [backend, &operation]{ UseStubBackend(backend); RunOrExit(operation); },
+			                                     [&operation]{ RunOrExit(operation); }));
+		}
+	}
+
+	std::cout << "\nPhases of a cold SaveFile with stub backends\n";
+
+	for(const char* const backend : StubBackends)
+	{
+		std::cout << "  " << backend << '\n';
+		static_cast<void>(MeasureCold(1, [backend]{ UseStubBackend(backend); MD::SetTraceSink(PrintTraceEvent); },
+		                                 []{ RunOrExit(DialogOperations[0]); }));
+	}
+
+	std::cout << '\n';
+}
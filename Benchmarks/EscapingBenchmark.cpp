@@ -0,0 +1,237 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ModernDialogsDetail.h>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	/// <summary>
+	/// Build a message of roughly the given size, with a quote, an ampersand and a newline every few hundred bytes.
+	/// </summary>
+	/// <param name="size">Size of the message in bytes.</param>
+	/// <returns>Message text.</returns>
+	[[nodiscard]] std::string BuildMessage(const std::size_t size)
+	{
+		std::string message{};
+		message.reserve(size + 128);
+		while(message.size() < size)
+			message += "The file couldn't be saved because the disk of O'Brien & Partners is full, free some space and try again.\n"
+			           "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore. ";
+		message.resize(size);
+
+		return message;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Build the given number of default paths, every tenth one containing a quote.
+	/// </summary>
+	/// <param name="pathCount">Number of paths.</param>
+	/// <returns>Default paths.</returns>
+	[[nodiscard]] std::vector<std::string> BuildPaths(const uint32_t pathCount)
+	{
+		std::vector<std::string> paths{};
+		paths.reserve(pathCount);
+		for(uint32_t i = 0; i < pathCount; ++i)
+		{
+			paths.push_back(std::string(i % 10 == 0 ? "/home/o'brien" : "/home/user") +
+			                "/Documents/Project/Some Subfolder/Report_" + std::to_string(i) + ".pdf");
+		}
+
+		return paths;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Escape for a Python string literal one character at a time, as a baseline for the vectorised scan.
+	/// </summary>
+	void AppendPythonEscapedScalar(std::string& out, const std::string_view text)
+	{
+		for(const char c : text)
+		{
+			if(c == '\n')
+				out += "\\n";
+			else if(c == '\r')
+				out += "\\r";
+			else if(c == '\0')
+				out += "\\x00";
+			else if(c == '\\' || c == '\'')
+			{
+				out += '\\';
+				out += c;
+			}
+			else
+				out += c;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Escape for Pango markup one character at a time, as a baseline for the vectorised scan.
+	/// </summary>
+	void AppendMarkupEscapedScalar(std::string& out, const std::string_view text)
+	{
+		for(const char c : text)
+		{
+			if(c == '&')
+				out += "&amp;";
+			else if(c == '<')
+				out += "&lt;";
+			else if(c == '>')
+				out += "&gt;";
+			else
+				out += c;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Check a file name with a per-character lambda, the way FilenameValid() does for short names.
+	/// </summary>
+	[[nodiscard]] bool FilenameValidScalar(const std::string_view filename)
+	{
+		return std::all_of(filename.cbegin(), filename.cend(), [](const char c)
+		{
+			return c != '\\' && c != '/' && c != ':' && c != '*' && c != '?' &&
+			       c != '\"' && c != '<' && c != '>' && c != '|';
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool FilenameValidVectorised(const std::string_view filename)
+	{
+		return MD::Detail::FindFirstOf(filename, "\\/:*?\"<>|") == std::string_view::npos;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Measure escaping all texts into a single reused buffer.
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="texts">Texts to escape.</param>
+	/// <param name="escape">Escaping function to measure.</param>
+	/// <returns>Samples in milliseconds.</returns>
+	[[nodiscard]] std::vector<double> MeasureEscape(const uint32_t samples, const std::vector<std::string>& texts,
+	                                                void(*escape)(std::string&, std::string_view))
+	{
+		std::vector<double> results{};
+		results.reserve(samples);
+
+		std::string out{};
+		std::size_t escapedSize = 0;
+		for(uint32_t i = 0; i < samples; ++i)
+		{
+			results.push_back(Benchmarks::Measure([&]
+			{
+				for(const std::string& text : texts)
+				{
+					out.clear();
+					escape(out, text);
+					escapedSize += out.size();
+				}
+			}));
+		}
+
+		//Keep the result observable, so the work can't be optimized away
+		if(escapedSize == 0)
+			results.clear();
+
+		return results;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Measure validating the last name of every path.
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="paths">Paths whose names get validated.</param>
+	/// <param name="valid">Validation function to measure.</param>
+	/// <returns>Samples in milliseconds.</returns>
+	[[nodiscard]] std::vector<double> MeasureValidation(const uint32_t samples, const std::vector<std::string>& paths,
+	                                                    bool(*valid)(std::string_view))
+	{
+		std::vector<double> results{};
+		results.reserve(samples);
+
+		std::size_t validCount = 0;
+		for(uint32_t i = 0; i < samples; ++i)
+		{
+			results.push_back(Benchmarks::Measure([&]
+			{
+				for(const std::string& path : paths)
+					validCount += valid(std::string_view(path).substr(path.find_last_of('/') + 1)) ? 1 : 0;
+			}));
+		}
+
+		if(validCount == 0)
+			results.clear();
+
+		return results;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::RunEscapingBenchmark(const uint32_t samples)
+{
+	for(const std::size_t size : {4096u, 65536u})
+	{
+		//Escape the message a hundred times per sample, a single one is too fast to time
+		const std::vector<std::string> messages(100, BuildMessage(size));
+		const std::string suffix = " (100 x " + std::to_string(size / 1024) + " KiB message)";
+
+		Report("Python escaping, scalar" + suffix, MeasureEscape(samples, messages, AppendPythonEscapedScalar));
+		Report("Python escaping, vectorised" + suffix, MeasureEscape(samples, messages, MD::Detail::AppendPythonEscaped));
+		Report("Markup escaping, scalar" + suffix, MeasureEscape(samples, messages, AppendMarkupEscapedScalar));
+		Report("Markup escaping, vectorised" + suffix, MeasureEscape(samples, messages, MD::Detail::AppendMarkupEscaped));
+	}
+
+	const std::vector<std::string> paths = BuildPaths(10000u);
+
+	Report("Python escaping, scalar (10000 default paths)", MeasureEscape(samples, paths, AppendPythonEscapedScalar));
+	Report("Python escaping, vectorised (10000 default paths)", MeasureEscape(samples, paths, MD::Detail::AppendPythonEscaped));
+	Report("File name validation, scalar (10000 names)", MeasureValidation(samples, paths, FilenameValidScalar));
+	Report("File name validation, vectorised (10000 names)", MeasureValidation(samples, paths, FilenameValidVectorised));
+
+	//FilenameValid() only switches to the vectorised scan for long names, these have 204 bytes
+	const std::vector<std::string> longNames(10000u, "/home/user/" + std::string(200, 'x') + ".pdf");
+
+	Report("File name validation, scalar (10000 long names)", MeasureValidation(samples, longNames, FilenameValidScalar));
+	Report("File name validation, vectorised (10000 long names)", MeasureValidation(samples, longNames, FilenameValidVectorised));
+}
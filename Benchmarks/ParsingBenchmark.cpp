@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ModernDialogsDetail.h>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	/// <summary>
+	/// Build a multi-select output with the given number of paths, each terminated by separator.
+	/// </summary>
+	/// <param name="pathCount">Number of paths.</param>
+	/// <param name="separator">Separator terminating the paths.</param>
+	/// <returns>Simulated backend output.</returns>
+	[[nodiscard]] std::string BuildOutput(const uint32_t pathCount, const char separator)
+	{
+		std::string output{};
+		for(uint32_t i = 0; i < pathCount; ++i)
+		{
+			output += "/home/user/Documents/Project/Some Subfolder/File_" + std::to_string(i) + ".txt";
+			output += separator;
+		}
+
+		return output;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Split the output the way it was done before, copying the remaining output for every path.
+	/// </summary>
+	/// <param name="tmp">Simulated backend output.</param>
+	/// <param name="separator">Separator between the paths.</param>
+	/// <returns>Parsed paths.</returns>
+	[[nodiscard]] std::vector<std::string> LegacySplit(std::string tmp, const char separator)
+	{
+		if(!tmp.empty() && tmp.back() == separator)
+			tmp.pop_back();
+
+		std::vector<std::string> paths{};
+		tmp += separator;
+		std::size_t pos = 0;
+		while((pos = tmp.find(separator)) != std::string::npos)
+		{
+			std::string token = tmp.substr(0, pos);
+			paths.push_back(std::move(token));
+			tmp.erase(0, pos + 1);
+		}
+
+		return paths;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Split the output with the single pass splitter and copy the paths into owned strings.
+	/// </summary>
+	/// <param name="output">Simulated backend output.</param>
+	/// <param name="separator">Separator terminating the paths.</param>
+	/// <returns>Parsed paths.</returns>
+	[[nodiscard]] std::vector<std::string> Split(const std::string_view output, const char separator)
+	{
+		const std::vector<std::string_view> pathViews = MD::Detail::SplitPaths(output, separator);
+
+		std::vector<std::string> paths{};
+		paths.reserve(pathViews.size());
+		for(const std::string_view path : pathViews)
+			paths.emplace_back(path);
+
+		return paths;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Measure func on the given output.
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="output">Simulated backend output.</param>
+	/// <param name="func">Parser to measure.</param>
+	/// <returns>Samples in milliseconds.</returns>
+	template<typename F>
+	[[nodiscard]] std::vector<double> MeasureSplit(const uint32_t samples, const std::string& output, F func)
+	{
+		std::vector<double> results{};
+		results.reserve(samples);
+
+		std::size_t pathCount = 0;
+		for(uint32_t i = 0; i < samples; ++i)
+			results.push_back(Benchmarks::Measure([&]{ pathCount += func(output).size(); }));
+
+		//Keep the result observable, so the work can't be optimized away
+		if(pathCount == 0)
+			results.clear();
+
+		return results;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::RunParsingBenchmark(const uint32_t samples)
+{
+	for(const uint32_t pathCount : {1000u, 10000u, 100000u})
+	{
+		const std::string newlineOutput = BuildOutput(pathCount, '\n');
+		const std::string nulOutput = BuildOutput(pathCount, '\0');
+		const std::string suffix = " (" + std::to_string(pathCount) + " paths)";
+
+		//The old parser is quadratic, 100k paths would take minutes
+		if(pathCount <= 10000u)
+			Report("Legacy split" + suffix, MeasureSplit(samples, newlineOutput, [](const std::string& output){ return LegacySplit(output, '\n'); }));
+
+		Report("Single pass split, newline" + suffix, MeasureSplit(samples, newlineOutput, [](const std::string& output){ return Split(output, '\n'); }));
+		Report("Single pass split, NUL" + suffix, MeasureSplit(samples, nulOutput, [](const std::string& output){ return Split(output, '\0'); }));
+	}
+}
@@ -0,0 +1,179 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ModernDialogsDetail.h>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	/// <summary>
+	/// Build a multi-select output with the given number of newline terminated paths.
+	/// </summary>
+	/// <param name="pathCount">Number of paths.</param>
+	/// <param name="folder">Folder containing the files.</param>
+	/// <param name="name">Name of the files, followed by their index.</param>
+	/// <returns>Simulated backend output.</returns>
+	[[nodiscard]] std::string BuildOutput(const uint32_t pathCount, const std::string_view folder, const std::string_view name)
+	{
+		std::string output{};
+		for(uint32_t i = 0; i < pathCount; ++i)
+		{
+			output += folder;
+			output += name;
+			output += std::to_string(i) + ".txt\n";
+		}
+
+		return output;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Validate UTF-8 one byte at a time, as a baseline for the vectorised ASCII skip.<br>
+	/// Same rules as MD::Detail::FindInvalidUTF8().
+	/// </summary>
+	[[nodiscard]] std::size_t FindInvalidUTF8Scalar(const std::string_view text)
+	{
+		std::size_t pos = 0;
+		while(pos < text.size())
+		{
+			const unsigned char lead = static_cast<unsigned char>(text[pos]);
+			std::size_t length = 1;
+			unsigned char low = 0x80u;
+			unsigned char high = 0xBFu;
+			if(lead >= 0xC2u && lead <= 0xDFu)
+				length = 2;
+			else if(lead >= 0xE0u && lead <= 0xEFu)
+			{
+				length = 3;
+				low = lead == 0xE0u ? 0xA0u : 0x80u;
+				high = lead == 0xEDu ? 0x9Fu : 0xBFu;
+			}
+			else if(lead >= 0xF0u && lead <= 0xF4u)
+			{
+				length = 4;
+				low = lead == 0xF0u ? 0x90u : 0x80u;
+				high = lead == 0xF4u ? 0x8Fu : 0xBFu;
+			}
+			else if(lead >= 0x80u)
+				return pos;
+
+			for(std::size_t i = 1; i < length; ++i)
+			{
+				const unsigned char byte = pos + i < text.size() ? static_cast<unsigned char>(text[pos + i]) : 0u;
+				if(byte < (i == 1 ? low : 0x80u) || byte > (i == 1 ? high : 0xBFu))
+					return pos;
+			}
+
+			pos += length;
+		}
+
+		return std::string_view::npos;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Measure validating the whole output at once.
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="output">Simulated backend output.</param>
+	/// <param name="validate">Validation function to measure.</param>
+	/// <returns>Samples in milliseconds.</returns>
+	[[nodiscard]] std::vector<double> MeasureValidation(const uint32_t samples, const std::string& output,
+	                                                    std::size_t(*validate)(std::string_view))
+	{
+		std::vector<double> results{};
+		results.reserve(samples);
+
+		std::size_t invalidCount = 0;
+		for(uint32_t i = 0; i < samples; ++i)
+			results.push_back(Benchmarks::Measure([&]{ invalidCount += validate(output) != std::string_view::npos ? 1 : 0; }));
+
+		//The outputs are valid, an invalid result means the validator is broken
+		if(invalidCount != 0)
+			results.clear();
+
+		return results;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Measure normalizing every path of the output to NFC, the way returned paths are normalized.
+	/// </summary>
+	/// <param name="samples">Number of samples to take.</param>
+	/// <param name="output">Simulated backend output.</param>
+	/// <returns>Samples in milliseconds.</returns>
+	[[nodiscard]] std::vector<double> MeasureNormalization(const uint32_t samples, const std::string& output)
+	{
+		const std::vector<std::string_view> pathViews = MD::Detail::SplitPaths(output, '\n');
+
+		std::vector<double> results{};
+		results.reserve(samples);
+
+		std::size_t changedCount = 0;
+		for(uint32_t i = 0; i < samples; ++i)
+		{
+			std::vector<std::string> paths(pathViews.cbegin(), pathViews.cend());
+			results.push_back(Benchmarks::Measure([&]
+			{
+				for(std::string& path : paths)
+					changedCount += MD::Detail::NormalizeToNFC(path) ? 1 : 0;
+			}));
+		}
+
+		//Keep the result observable, so the work can't be optimized away
+		if(changedCount == static_cast<std::size_t>(-1))
+			results.clear();
+
+		return results;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::RunUnicodeBenchmark(const uint32_t samples)
+{
+	constexpr uint32_t PathCount = 100000u;
+	const std::string asciiOutput = BuildOutput(PathCount, "/home/user/Documents/Project/Some Subfolder/", "File_");
+	//Decomposed (NFD) names, the way some file managers and macOS shares store them
+	const std::string unicodeOutput = BuildOutput(PathCount, "/home/user/Dokumente/Pla\xCC\x88ne/Entwu\xCC\x88rfe/", "\xE8\xA8\xAD\xE8\xA8\x88_Cafe\xCC\x81_");
+	const std::string suffix = " (" + std::to_string(PathCount / 1000u) + "k paths)";
+
+	Report("UTF-8 validation, scalar, ASCII" + suffix, MeasureValidation(samples, asciiOutput, FindInvalidUTF8Scalar));
+	Report("UTF-8 validation, vectorised, ASCII" + suffix, MeasureValidation(samples, asciiOutput, [](const std::string_view text){ return MD::Detail::FindInvalidUTF8(text); }));
+	Report("UTF-8 validation, scalar, non-ASCII" + suffix, MeasureValidation(samples, unicodeOutput, FindInvalidUTF8Scalar));
+	Report("UTF-8 validation, vectorised, non-ASCII" + suffix, MeasureValidation(samples, unicodeOutput, [](const std::string_view text){ return MD::Detail::FindInvalidUTF8(text); }));
+
+	//Without GLib both only take the ASCII check
+	Report("NFC normalization, ASCII" + suffix, MeasureNormalization(samples, asciiOutput));
+	Report("NFC normalization, non-ASCII" + suffix, MeasureNormalization(samples, unicodeOutput));
+}
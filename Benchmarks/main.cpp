@@ -0,0 +1,193 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Benchmarks.h"
+
+//Directory containing one directory of stub executables per backend.
+//premake passes an absolute path, the fallback works when running from the repository root.
+#ifndef MD_BENCHMARK_STUBS_DIR
+	#define MD_BENCHMARK_STUBS_DIR "Benchmarks/Stubs"
+#endif
+
+Benchmarks::Statistics Benchmarks::Summarize(std::vector<double> samples)
+{
+	Statistics stats{};
+	if(samples.empty())
+		return stats;
+
+	std::sort(samples.begin(), samples.end());
+
+	const auto percentile = [&samples](const double p)
+	{
+		const std::size_t index = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+		return samples[std::min(index, samples.size() - 1)];
+	};
+
+	stats.Min = samples.front();
+	stats.Max = samples.back();
+	stats.Mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+	stats.P50 = percentile(0.50);
+	stats.P90 = percentile(0.90);
+	stats.P99 = percentile(0.99);
+
+	return stats;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::Report(const std::string_view name, const std::vector<double>& samples)
+{
+	if(samples.empty())
+	{
+		std::cout << std::left << std::setw(52) << name << " (no samples)\n";
+		return;
+	}
+
+	const Statistics stats = Summarize(samples);
+
+	std::cout << std::left << std::setw(52) << name << std::right << std::fixed << std::setprecision(3)
+	          << " n=" << std::setw(5) << samples.size()
+	          << " min=" << std::setw(9) << stats.Min
+	          << " p50=" << std::setw(9) << stats.P50
+	          << " p90=" << std::setw(9) << stats.P90
+	          << " p99=" << std::setw(9) << stats.P99
+	          << " max=" << std::setw(9) << stats.Max << " ms\n";
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+double Benchmarks::Measure(const std::function<void()>& func)
+{
+	const auto start = std::chrono::steady_clock::now();
+	func();
+	const auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::vector<double> Benchmarks::MeasureCold(const uint32_t samples, const std::function<void()>& func)
+{
+	return MeasureCold(samples, []{}, func);
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::vector<double> Benchmarks::MeasureCold(const uint32_t samples, const std::function<void()>& setup, const std::function<void()>& func)
+{
+	return SampleCold(samples, setup, [&func]{ return Measure(func); });
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::vector<double> Benchmarks::SampleCold(const uint32_t samples, const std::function<void()>& setup, const std::function<double()>& func)
+{
+	std::vector<double> results{};
+
+#ifdef __linux__
+	results.reserve(samples);
+
+	//Children must not inherit pending output
+	std::cout.flush();
+
+	for(uint32_t i = 0; i < samples; ++i)
+	{
+		int fds[2]{};
+		if(pipe(fds) != 0)
+			break;
+
+		const pid_t pid = fork();
+		if(pid < 0)
+		{
+			close(fds[0]);
+			close(fds[1]);
+			break;
+		}
+
+		if(pid == 0)
+		{
+			close(fds[0]);
+			setup();
+			const double sample = func();
+			[[maybe_unused]] const ssize_t written = write(fds[1], &sample, sizeof(sample));
+			close(fds[1]);
+			std::exit(0); //Run static destructors, so background threads of the library get joined
+		}
+
+		close(fds[1]);
+		double sample = 0.0;
+		const bool valid = read(fds[0], &sample, sizeof(sample)) == static_cast<ssize_t>(sizeof(sample));
+		close(fds[0]);
+		waitpid(pid, nullptr, 0);
+
+		if(valid)
+			results.push_back(sample);
+	}
+#else
+	(void)samples;
+	(void)setup;
+	(void)func;
+#endif
+
+	return results;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void Benchmarks::UseStubBackend([[maybe_unused]] const char* const backend)
+{
+#ifdef __linux__
+	const std::string path = std::string(MD_BENCHMARK_STUBS_DIR) + '/' + backend;
+	setenv("PATH", path.c_str(), 1);
+	setenv("DISPLAY", ":0", 1);
+	unsetenv("WAYLAND_DISPLAY");
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+int main(int argc, char* argv[])
+{
+	const uint32_t samples = argc > 1 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[1]))) : 25u;
+
+	Benchmarks::RunDetectionBenchmark(samples);
+	Benchmarks::RunConcurrencyBenchmark(samples);
+	Benchmarks::RunParsingBenchmark(samples);
+	Benchmarks::RunEscapingBenchmark(samples);
+	Benchmarks::RunUnicodeBenchmark(samples);
+	Benchmarks::RunEndToEndBenchmark(samples);
+}
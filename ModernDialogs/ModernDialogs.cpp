@@ -23,11 +23,30 @@ SOFTWARE.
 */
 
 #include "ModernDialogs.h"
+#include "ModernDialogsDetail.h"
 
 #include <algorithm>
 #include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <future>
+#include <mutex>
 #include <array>
+#include <cerrno>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <cstring>
+#include <charconv>
+#include <deque>
+#include <utility>
+#include <initializer_list>
 
 #ifdef _WIN32
 #ifndef _WIN32_WINNT
@@ -44,7 +63,30 @@ SOFTWARE.
 #include <dirent.h>
 #include <termios.h>
 #include <sys/utsname.h>
+#include <sys/stat.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <dlfcn.h>
+#endif
+
+//Vector width of MD::Detail::FindFirstOf(), SSE2 is part of every x86-64 CPU, AVX2 only gets used when the compiler targets it
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MD_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MD_SIMD_SSE2
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define MD_SIMD_NEON
+#endif
+
+#if defined(_MSC_VER) && (defined(MD_SIMD_AVX2) || defined(MD_SIMD_SSE2))
+#include <intrin.h>
 #endif
 
 #if _MSVC_LANG >= 202002L || __cplusplus >= 202002L
@@ -53,6 +95,33 @@ SOFTWARE.
 #define CPP20Constexpr
 #endif
 
+/// <summary>
+/// Filters of a MD::FilterSet, parsed once on construction.<br>
+/// The filter arguments of the Linux backends are rendered on first use and shared by all copies of the set.
+/// </summary>
+struct MD::FilterSet::Data
+{
+	//Filters without empty patterns, for backends taking name and patterns as is
+	std::vector<std::pair<std::string, std::string>> Filters{};
+	//Patterns of every filter, views into Filters
+	std::vector<std::vector<std::string_view>> Patterns{};
+	//Total size of all names and patterns
+	std::size_t TextSize = 0;
+	std::size_t PatternCount = 0;
+	bool AllFiles = true;
+
+#ifndef _WIN32
+	mutable std::once_flag KDialogOnce{};
+	mutable std::string KDialog{};
+	mutable std::once_flag GenericOnce{};
+	mutable std::vector<std::string> Generic{};
+	mutable std::once_flag TKinterOnce{};
+	mutable std::string TKinter{};
+#endif
+};
+
+//-------------------------------------------------------------------------------------------------------------------//
+
 namespace
 {
 	//-------------------------------------------------------------------------------------------------------------------//
@@ -62,32 +131,105 @@ namespace
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] CPP20Constexpr std::string GetPathWithoutFinalSlash(const std::string& source)
+	//Set by MD::SetParentWindow(), 0 to use the active window
+	std::atomic<uint64_t> ParentWindow{0};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+#ifndef MD_DISABLE_TRACING
+	std::atomic<bool> TracingEnabled{false};
+	std::mutex TraceSinkMutex{};
+	MD::TraceSink DialogTraceSink{};
+#endif
+
+	[[nodiscard]] bool IsTracing() noexcept
 	{
-		if(source.empty())
-			return "";
+#ifdef MD_DISABLE_TRACING
+		return false;
+#else
+		return TracingEnabled.load(std::memory_order_relaxed);
+#endif
+	}
 
-		std::size_t index = source.find_last_of('/');
-		if (index == std::string_view::npos)
-			index = source.find_last_of('\\');
+	//-------------------------------------------------------------------------------------------------------------------//
 
-		if (index == std::string_view::npos)
-			return "";
+	void EmitTraceEvent([[maybe_unused]] const MD::TraceEvent& event)
+	{
+#ifndef MD_DISABLE_TRACING
+		MD::TraceSink sink{};
+		{
+			const std::lock_guard lock(TraceSinkMutex);
+			sink = DialogTraceSink;
+		}
 
-		return source.substr(0, index);
+		if(sink)
+			sink(event);
+#endif
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] CPP20Constexpr std::string GetLastName(const std::string& source)
+	/// <summary>
+	/// Reports the time spent in the enclosing scope to the trace sink.<br>
+	/// Costs a single branch if tracing is disabled, nothing if it is compiled out.
+	/// </summary>
+	class TraceScope
 	{
-		if (source.empty())
-			return "";
+	public:
+		TraceScope(const MD::TracePhase phase, const std::string_view backend, const std::string_view detail = {})
+			: m_tracing(IsTracing()), m_phase(phase), m_backend(backend), m_detail(detail)
+		{
+			if(m_tracing)
+				m_start = std::chrono::steady_clock::now();
+		}
+
+		~TraceScope()
+		{
+			if(m_tracing)
+				EmitTraceEvent({m_phase, m_backend, m_detail, m_start, std::chrono::steady_clock::now()});
+		}
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+	private:
+		bool m_tracing;
+		MD::TracePhase m_phase;
+		std::string_view m_backend;
+		std::string_view m_detail;
+		std::chrono::steady_clock::time_point m_start{};
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Find the separator in front of the last name of the given path, '/' is preferred over '\\'.
+	/// </summary>
+	[[nodiscard]] constexpr std::size_t FindFinalSlash(const std::string_view source) noexcept
+	{
+		const std::size_t index = source.find_last_of('/');
+		if (index != std::string_view::npos)
+			return index;
+
+		return source.find_last_of('\\');
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
 
-		std::size_t index = source.find_last_of('/');
+	[[nodiscard]] constexpr std::string_view GetPathViewWithoutFinalSlash(const std::string_view source) noexcept
+	{
+		const std::size_t index = FindFinalSlash(source);
 		if (index == std::string_view::npos)
-			index = source.find_last_of('\\');
+			return {};
+
+		return source.substr(0, index);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
 
+	[[nodiscard]] constexpr std::string_view GetLastNameView(const std::string_view source) noexcept
+	{
+		const std::size_t index = FindFinalSlash(source);
 		if (index == std::string_view::npos)
 			return source;
 
@@ -96,9 +238,37 @@ namespace
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
+	[[nodiscard]] CPP20Constexpr std::string GetPathWithoutFinalSlash(const std::string& source)
+	{
+		return std::string(GetPathViewWithoutFinalSlash(source));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] CPP20Constexpr std::string GetLastName(const std::string& source)
+	{
+		return std::string(GetLastNameView(source));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
 //Windows land
 #ifdef _WIN32
 
+	/// <summary>
+	/// Owner of the file dialogs, the window set by MD::SetParentWindow() or the foreground window.
+	/// </summary>
+	[[nodiscard]] HWND GetOwnerWindow()
+	{
+		const uint64_t parentWindow = ParentWindow;
+		if(parentWindow != 0)
+			return reinterpret_cast<HWND>(static_cast<uintptr_t>(parentWindow));
+
+		return GetForegroundWindow();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
 	[[nodiscard]] CPP20Constexpr std::wstring GetPathWithoutFinalSlashW(const std::wstring& source)
 	{
 		if(source.empty())
@@ -259,7 +429,7 @@ namespace
 
 		OPENFILENAMEW ofn{};
 		ofn.lStructSize = sizeof(OPENFILENAMEW);
-		ofn.hwndOwner = GetForegroundWindow();
+		ofn.hwndOwner = GetOwnerWindow();
 		ofn.hInstance = nullptr;
 		ofn.lpstrFilter = filterPatternsStr.empty() ? nullptr : filterPatternsStr.c_str();
 		ofn.nFilterIndex = 1;
@@ -359,7 +529,7 @@ namespace
 
 		OPENFILENAMEW ofn{};
 		ofn.lStructSize = sizeof(OPENFILENAMEW);
-		ofn.hwndOwner = GetForegroundWindow();
+		ofn.hwndOwner = GetOwnerWindow();
 		ofn.lpstrFilter = filterPatternsStr.empty() ? nullptr : filterPatternsStr.c_str();
 		ofn.nFilterIndex = 1;
 		ofn.lpstrFile = buffer.data();
@@ -443,7 +613,7 @@ namespace
 		HRESULT hResult = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
 
 		BROWSEINFOW info{};
-		info.hwndOwner = GetForegroundWindow();
+		info.hwndOwner = GetOwnerWindow();
 		info.pszDisplayName = buffer.data();
 		info.lpszTitle = title.empty() ? nullptr : title.c_str();
 		if (hResult == S_OK || hResult == S_FALSE)
@@ -569,7 +739,8 @@ namespace
 		flags |= GetIcon(style);
 		flags |= GetButtons(buttons);
 
-		return GetSelection(MessageBoxW(nullptr, wMessage.c_str(), wTitle.c_str(), flags), buttons);
+		//Message boxes only get an owner if one was set explicitly
+		return GetSelection(MessageBoxW(reinterpret_cast<HWND>(static_cast<uintptr_t>(ParentWindow.load())), wMessage.c_str(), wTitle.c_str(), flags), buttons);
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
@@ -577,1420 +748,7055 @@ namespace
 //Linux land
 #else
 
-	std::string Python3Name{};
+	[[nodiscard]] bool IsExecutableFile(const std::string& path)
+	{
+		struct stat info{};
+		if(stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+			return false;
+
+		return access(path.c_str(), X_OK) == 0;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Absolute paths of every executable ModernDialogs may use.<br>
+	/// An empty string means the executable was not found on PATH.
+	/// </summary>
+	struct ExecutablePaths
+	{
+		std::string XProp{};
+		std::string Zenity{};
+		std::string MateDialog{};
+		std::string Shellementary{};
+		std::string Qarma{};
+		std::string Yad{};
+		std::string KDialog{};
+		std::string Python3{};
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool DetectPresence(const std::string& executable)
+	/// <summary>
+	/// Walks PATH a single time in-process and resolves every backend executable.<br>
+	/// This replaces spawning a shell with "command -v" for each executable.
+	/// </summary>
+	[[nodiscard]] ExecutablePaths ResolveExecutables()
 	{
-		std::array<char, 128> buffer{};
-		std::string output{};
+		const TraceScope trace(MD::TracePhase::Detection, {}, "executable lookup");
+
+		//Python 3 interpreters in order of preference
+		constexpr std::array<std::string_view, 12> Python3Names
+		{
+			"python3", "python3.10", "python3.9", "python3.8", "python3.7", "python3.6",
+			"python3.5", "python3.4", "python3.3", "python3.2", "python3.1", "python3.0"
+		};
+
+		ExecutablePaths paths{};
+		std::array<std::string, Python3Names.size()> python3Paths{};
 
-		const std::string cmd = "command -v " + executable + " 2>/dev/null";
+		const std::array<std::pair<std::string_view, std::string*>, 7> executables
+		{
+			{
+				{"xprop", &paths.XProp},
+				{"zenity", &paths.Zenity},
+				{"matedialog", &paths.MateDialog},
+				{"shellementary", &paths.Shellementary},
+				{"qarma", &paths.Qarma},
+				{"yad", &paths.Yad},
+				{"kdialog", &paths.KDialog}
+			}
+		};
 
-		FILE* const in = popen(cmd.c_str(), "r");
+		const char* const pathEnv = std::getenv("PATH");
+		const std::string_view pathList = pathEnv ? pathEnv : "/usr/local/bin:/usr/bin:/bin";
 
-		while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-			output += buffer.data();
+		std::string candidate{};
+		candidate.reserve(MaxPathOrCMD);
 
-		pclose(in);
+		const auto tryCandidate = [&candidate](const std::string_view dir, const std::string_view name, std::string& outPath)
+		{
+			if(!outPath.empty())
+				return;
 
-		return !output.empty() && output.find(':') == std::string::npos && output.find("no ") == std::string::npos;
-	}
+			candidate.assign(dir.empty() ? std::string_view(".") : dir);
+			candidate += '/';
+			candidate += name;
 
-	//-------------------------------------------------------------------------------------------------------------------//
+			if(IsExecutableFile(candidate))
+				outPath = candidate;
+		};
 
-	[[nodiscard]] int32_t GetEnvDISPLAY()
-	{
-		static int32_t returnValue = -1;
+		std::size_t start = 0;
+		while(start <= pathList.size())
+		{
+			std::size_t end = pathList.find(':', start);
+			if(end == std::string_view::npos)
+				end = pathList.size();
 
-		if(returnValue < 0)
+			const std::string_view dir = pathList.substr(start, end - start);
+
+			for(const auto& [name, outPath] : executables)
+				tryCandidate(dir, name, *outPath);
+			for(std::size_t i = 0; i < Python3Names.size(); ++i)
+				tryCandidate(dir, Python3Names[i], python3Paths[i]);
+
+			start = end + 1;
+		}
+
+		for(std::size_t i = 0; i < Python3Names.size(); ++i)
 		{
-			returnValue = 0;
-			if(std::getenv("DISPLAY"))
-				returnValue += 1;
-			if(std::getenv("WAYLAND_DISPLAY"))
-				returnValue += 2;
+			if(!python3Paths[i].empty())
+			{
+				paths.Python3 = python3Paths[i];
+				break;
+			}
 		}
 
-		return returnValue;
+		return paths;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool IsDarwin()
+	[[nodiscard]] const ExecutablePaths& GetExecutables()
 	{
-		static int32_t isDarwin = -1;
-		struct utsname lUtsname;
-
-		if (isDarwin < 0)
-			isDarwin = !uname(&lUtsname) && std::string_view(lUtsname.sysname) == "Darwin";
+		static const ExecutablePaths executables = ResolveExecutables();
 
-		return isDarwin;
+		return executables;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool GraphicMode()
+	/// <summary>
+	/// Results of probes which need to spawn a child process or call the session bus.<br>
+	/// These can be persisted in the detection cache.
+	/// </summary>
+	enum class CachedProbe : uint32_t
 	{
-		return (GetEnvDISPLAY() || (IsDarwin() && GetEnvDISPLAY()));
-	}
+		Zenity3,
+		KDialog,
+		XProp,
+		TKinter3,
+		Portal,
+
+		Count
+	};
+
+	constexpr std::array<std::string_view, static_cast<uint32_t>(CachedProbe::Count)> CachedProbeNames
+	{
+		"zenity3", "kdialog", "xprop", "tkinter3", "portal"
+	};
+
+	std::atomic<bool> DetectionCacheEnabled = false;
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool XPropPresent()
+	[[nodiscard]] std::filesystem::path GetDetectionCacheFile()
 	{
-		static bool xpropReady = false;
-		static int32_t xpropPresent = -1;
+		std::filesystem::path cacheDir{};
 
-		if (xpropPresent < 0)
-		{
-			if(GetEnvDISPLAY() & 1)
-				xpropPresent = DetectPresence("xprop");
-			else
-				xpropPresent = 0;
-		}
+		const char* const xdgCacheHome = std::getenv("XDG_CACHE_HOME");
+		if(xdgCacheHome && xdgCacheHome[0] == '/')
+			cacheDir = xdgCacheHome;
+		else if(const char* const home = std::getenv("HOME"); home && home[0] != '\0')
+			cacheDir = std::filesystem::path(home) / ".cache";
+		else
+			return {};
 
-		if(!xpropPresent)
-			return 0;
+		return cacheDir / "ModernDialogs" / "backends";
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
 
-		if(!xpropReady)
+	/// <summary>
+	/// Build the key which identifies the environment the cached probe results are valid for.<br>
+	/// It covers PATH, the display, session bus and desktop environment variables and the identity (inode, mtime)
+	/// of every resolved executable, so updating or removing a backend invalidates the cache.
+	/// </summary>
+	[[nodiscard]] std::string GetDetectionCacheKey()
+	{
+		constexpr std::array<const char*, 7> EnvVars
 		{
-			FILE* const in = popen("xprop -root 32x '\t$0' _NET_ACTIVE_WINDOW", "r");
+			"PATH", "DISPLAY", "WAYLAND_DISPLAY", "DBUS_SESSION_BUS_ADDRESS", "XDG_SESSION_DESKTOP", "XDG_CURRENT_DESKTOP", "DESKTOP_SESSION"
+		};
 
-			std::array<char, 128> buffer{};
-			std::string output{};
+		std::string key{};
+
+		for(const char* const envVar : EnvVars)
+		{
+			key += envVar;
+			key += '=';
+			if(const char* const value = std::getenv(envVar))
+				key += value;
+			key += '\n';
+		}
 
-			while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-				output += buffer.data();
+		const ExecutablePaths& executables = GetExecutables();
+		for(const std::string* const path : {&executables.XProp, &executables.Zenity, &executables.MateDialog,
+		                                     &executables.Shellementary, &executables.Qarma, &executables.Yad,
+		                                     &executables.KDialog, &executables.Python3})
+		{
+			key += *path;
 
-			pclose(in);
+			struct stat info{};
+			if(!path->empty() && stat(path->c_str(), &info) == 0)
+			{
+				key += ':' + std::to_string(info.st_ino) + ':' + std::to_string(info.st_mtim.tv_sec) +
+				       '.' + std::to_string(info.st_mtim.tv_nsec);
+			}
+			key += '\n';
+		}
 
-			if(output.find("not found") == std::string::npos)
-				xpropReady = true;
+		//FNV-1a, the key only needs to detect changes
+		uint64_t hash = 14695981039346656037ull;
+		for(const char c : key)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
 		}
 
-		return xpropReady && GraphicMode();
+		return std::to_string(hash);
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool ZenityPresent()
+	struct DetectionCache
 	{
-		static int32_t zenityPresent = -1;
-
-		if (zenityPresent < 0)
-			zenityPresent = DetectPresence("zenity");
-
-		return zenityPresent && GraphicMode();
-	}
+		std::string Key{};
+		std::array<int32_t, static_cast<uint32_t>(CachedProbe::Count)> Values{-1, -1, -1, -1, -1};
+	};
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] int32_t Zenity3Present()
+	[[nodiscard]] DetectionCache& GetDetectionCache()
 	{
-		static int32_t zenity3Present = -1;
-
-		if(zenity3Present < 0)
+		static DetectionCache cache = []()
 		{
-			zenity3Present = 0;
-			if(ZenityPresent())
-			{
-				std::array<char, 128> buffer{};
-				std::string output{};
-				FILE* const in = popen("zenity --version", "r");
+			DetectionCache result{};
+			result.Key = GetDetectionCacheKey();
 
-				while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-					output += buffer.data();
+			std::ifstream file(GetDetectionCacheFile());
+			std::string line{};
+			if(!file.is_open() || !std::getline(file, line) || line != "key=" + result.Key)
+				return result;
 
-				if(!output.empty() && std::stoi(output) >= 3)
+			while(std::getline(file, line))
+			{
+				const std::size_t separator = line.find('=');
+				if(separator == std::string::npos)
+					continue;
+
+				const std::string_view name = std::string_view(line).substr(0, separator);
+				for(uint32_t i = 0; i < CachedProbeNames.size(); ++i)
 				{
-					zenity3Present = 3;
-					const int32_t temp = std::stoi(output.substr(output.find_first_not_of('.') + 2));
-					if(temp >= 18)
-						zenity3Present = 5;
-					else if(temp >= 10)
-						zenity3Present = 4;
+					if(CachedProbeNames[i] == name)
+						result.Values[i] = std::atoi(line.c_str() + separator + 1);
 				}
-				else if(!output.empty() && (std::stoi(output) == 2) && (std::stoi(output.substr(output.find_first_not_of('.') + 2)) >= 32))
-					zenity3Present = 2;
-
-				pclose(in);
 			}
-		}
 
-		return GraphicMode() ? zenity3Present : 0;
+			return result;
+		}();
+
+		return cache;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool MateDialogPresent()
+	/// <summary>
+	/// Retrieve a probe result from the detection cache.
+	/// </summary>
+	/// <param name="probe">Probe to look up.</param>
+	/// <returns>Cached result or -1 if the cache is disabled or has no valid entry.</returns>
+	[[nodiscard]] int32_t GetCachedProbe(const CachedProbe probe)
 	{
-		static int32_t matedialogPresent = -1;
-
-		if(matedialogPresent < 0)
-			matedialogPresent = DetectPresence("matedialog");
+		if(!DetectionCacheEnabled)
+			return -1;
 
-		return matedialogPresent && GraphicMode();
+		return GetDetectionCache().Values[static_cast<uint32_t>(probe)];
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool ShellementaryPresent()
+	void StoreCachedProbe(const CachedProbe probe, const int32_t value)
 	{
-		static int32_t shellementaryPresent = -1;
+		if(!DetectionCacheEnabled)
+			return;
+
+		DetectionCache& cache = GetDetectionCache();
+		cache.Values[static_cast<uint32_t>(probe)] = value;
+
+		const std::filesystem::path cacheFile = GetDetectionCacheFile();
+		if(cacheFile.empty())
+			return;
 
-		if(shellementaryPresent < 0)
-			shellementaryPresent = DetectPresence("shellementary");
+		std::error_code ec{};
+		std::filesystem::create_directories(cacheFile.parent_path(), ec);
+		if(ec != std::error_code{})
+			return;
+
+		//Write to a temporary file and rename it, so concurrent processes never see a partial cache
+		const std::filesystem::path tmpFile = cacheFile.string() + "." + std::to_string(getpid());
+		{
+			std::ofstream file(tmpFile, std::ios::trunc);
+			if(!file.is_open())
+				return;
+
+			file << "key=" << cache.Key << '\n';
+			for(uint32_t i = 0; i < CachedProbeNames.size(); ++i)
+			{
+				if(cache.Values[i] >= 0)
+					file << CachedProbeNames[i] << '=' << cache.Values[i] << '\n';
+			}
+		}
 
-		return shellementaryPresent && GraphicMode();
+		std::filesystem::rename(tmpFile, cacheFile, ec);
+		if(ec != std::error_code{})
+			std::filesystem::remove(tmpFile, ec);
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool QarmaPresent()
+	[[nodiscard]] int32_t DetectEnvDISPLAY()
 	{
-		static int32_t qarmaPresent = -1;
-
-		if(qarmaPresent < 0)
-			qarmaPresent = DetectPresence("qarma");
+		int32_t returnValue = 0;
+		if(std::getenv("DISPLAY"))
+			returnValue += 1;
+		if(std::getenv("WAYLAND_DISPLAY"))
+			returnValue += 2;
 
-		return qarmaPresent && GraphicMode();
+		return returnValue;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool YadPresent()
+	[[nodiscard]] bool DetectDarwin()
 	{
-		static int32_t yadPresent = -1;
-
-		if(yadPresent < 0)
-			yadPresent = DetectPresence("yad");
+		struct utsname lUtsname;
 
-		return yadPresent && GraphicMode();
+		return !uname(&lUtsname) && std::string_view(lUtsname.sysname) == "Darwin";
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool Python3Present()
+	/// <summary>
+	/// Argument vector of a process, the first element is the absolute path of the executable.
+	/// </summary>
+	using Command = std::vector<std::string>;
+
+	/// <summary>
+	/// Fixed arguments selecting the dialog type, appended to a Command by the builders.
+	/// </summary>
+	using CommandAction = std::initializer_list<const char*>;
+
+	/// <summary>
+	/// Standard output of a process, read straight from its pipe into a geometrically growing buffer.
+	/// </summary>
+	struct ProcessOutput
 	{
-		static int32_t python3Present = -1;
+		std::unique_ptr<char[]> Data{};
+		std::size_t Size = 0;
+		std::size_t Capacity = 0;
+		//Set when the output exceeded the limit set by SetMaxDialogOutputSize(), the excess got discarded
+		bool Truncated = false;
 
-		if(python3Present < 0)
+		[[nodiscard]] std::string_view View() const noexcept
 		{
-			python3Present = 0;
-			Python3Name = "python3";
-			if(DetectPresence(Python3Name))
-				python3Present = 1;
-			else
-			{
-				for(int32_t i = 10; i >= 0; --i)
-				{
-					Python3Name = "python3." + std::to_string(i);
-					if(DetectPresence(Python3Name))
-					{
-						python3Present = 1;
-						break;
-					}
-				}
-			}
+			return {Data.get(), Size};
 		}
+	};
 
-		return python3Present;
-	}
+	struct ProcessResult
+	{
+		ProcessOutput Output;
+		int32_t ExitStatus = -1;
+	};
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool TryCommand(const std::string& command)
+	struct RunningProcess
 	{
-		std::array<char, 128> buffer{};
-		std::string output{};
+		pid_t Pid;
+		//Read end of the pipe connected to the standard output of the process
+		int32_t OutputFd;
+
+		//Only set while tracing
+		std::string_view Backend{};
+		std::chrono::steady_clock::time_point StartTime{};
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
 
-		FILE* const in = popen(command.data(), "r");
-		while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-			output += buffer.data();
+	/// <summary>
+	/// Reap the given process.
+	/// </summary>
+	/// <returns>Exit status or -1 if the process did not exit normally.</returns>
+	[[nodiscard]] int32_t WaitForExitStatus(const pid_t pid)
+	{
+		int32_t status = 0;
+		while(waitpid(pid, &status, 0) < 0)
+		{
+			if(errno != EINTR)
+				return -1;
+		}
 
-		pclose(in);
+		if(WIFEXITED(status))
+			return WEXITSTATUS(status);
 
-		return !output.empty();
+		return -1;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool TKinter3Present()
+	/// <summary>
+	/// Start the given executable in a child process which shares our memory until it calls exec.
+	/// </summary>
+	/// <param name="execError">Receives errno if exec failed in the child.</param>
+	/// <returns>Pid of the child or -1 if it could not be created.</returns>
+	[[nodiscard]] pid_t VForkExec(char* const* const argv,
+	                              const int32_t stdinFd,
+	                              const int32_t stdoutFd,
+	                              const int32_t stderrFd,
+	                              const sigset_t& signalMask,
+	                              int32_t& execError)
 	{
-		static int32_t tkinter3Present = -1;
+		const pid_t parentPid = getpid();
 
-		if(tkinter3Present < 0)
+		const pid_t pid = vfork();
+		if(pid == 0)
 		{
-			tkinter3Present = 0;
-			if(Python3Present())
-			{
-				static const std::string pythonParams = "-S -c \"try:\n\timport tkinter;\n\tprint(1);\nexcept:\n\tpass\"";
-				const std::string pythonCommand = Python3Name + " " + pythonParams;
-				tkinter3Present = TryCommand(pythonCommand);
-			}
+			setpgid(0, 0);
+			prctl(PR_SET_PDEATHSIG, SIGKILL);
+			if(getppid() != parentPid)
+				_exit(127);
+
+			if(stdinFd >= 0)
+				dup2(stdinFd, STDIN_FILENO);
+			dup2(stdoutFd, STDOUT_FILENO);
+			dup2(stderrFd, STDERR_FILENO);
+
+			sigprocmask(SIG_SETMASK, &signalMask, nullptr);
+			execve(argv[0], argv, environ);
+
+			execError = errno;
+			_exit(127);
 		}
 
-		return tkinter3Present && GraphicMode() && !IsDarwin();
+		return pid;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] int32_t KDialogPresent()
+	/// <summary>
+	/// Start a process directly (without a shell) with the given file descriptors as its standard streams.<br>
+	/// The process gets its own process group, so it can be terminated together with its children,
+	/// and is killed by the kernel if the spawning thread dies, so crashes don't leave stray dialogs behind.
+	/// </summary>
+	/// <param name="command">Argument vector, first element must be an absolute path.</param>
+	/// <param name="stdinFd">Descriptor for standard input or -1 to inherit ours.</param>
+	/// <param name="stdoutFd">Descriptor for standard output.</param>
+	/// <param name="stderrFd">Descriptor for standard error.</param>
+	/// <returns>Pid of the started process or -1 if it could not be started.</returns>
+	[[nodiscard]] pid_t StartProcess(const Command& command, const int32_t stdinFd, const int32_t stdoutFd, const int32_t stderrFd)
 	{
-		static int32_t kdialogPresent = -1;
-
-		if(kdialogPresent < 0)
+		if(command.empty() || command[0].empty())
+			return -1;
+
+		//Dialog commands are short, only long filter lists need the heap
+		std::array<char*, 32> argvBuffer{};
+		std::vector<char*> argvHeap{};
+		char** argv = argvBuffer.data();
+		if(command.size() + 1 > argvBuffer.size())
 		{
-			if(ZenityPresent())
-			{
-				auto desktopEnv = std::getenv("XDG_SESSION_DESKTOP");
-				if(!desktopEnv)
-				{
-					desktopEnv = std::getenv("XDG_CURRENT_DESKTOP");
-					if(!desktopEnv)
-					{
-						desktopEnv = std::getenv("DESKTOP_SESSION");
-
-						if(!desktopEnv)
-						{
-							kdialogPresent = 0;
-							return kdialogPresent;
-						}
-					}
-				}
-				const std::string desktop(desktopEnv);
-				if(desktop.empty() || (desktop != "KDE" && desktop != "kde" && desktop != "lxqt" && desktop != "LXQT"))
-				{
-					kdialogPresent = 0;
-					return kdialogPresent;
-				}
-			}
+			argvHeap.resize(command.size() + 1);
+			argv = argvHeap.data();
+		}
+		for(std::size_t i = 0; i < command.size(); ++i)
+			argv[i] = const_cast<char*>(command[i].c_str());
+		argv[command.size()] = nullptr;
 
-			kdialogPresent = DetectPresence("kdialog");
-			if(kdialogPresent)
-			{
-				std::array<char, 128> buffer{};
-				std::string output{};
+		//The child must not run signal handlers of the parent while sharing its memory
+		sigset_t allSignals{};
+		sigset_t oldMask{};
+		sigfillset(&allSignals);
+		pthread_sigmask(SIG_SETMASK, &allSignals, &oldMask);
 
-				FILE* const in = popen("kdialog --attach 2>&1", "r");
-				while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-					output += buffer.data();
+		int32_t execError = 0;
+		const pid_t pid = VForkExec(argv, stdinFd, stdoutFd, stderrFd, oldMask, execError);
 
-				pclose(in);
+		pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
 
-				if (output.find("Unknown") == std::string::npos)
-					kdialogPresent = 2;
-			}
+		if(pid > 0 && execError != 0)
+		{
+			static_cast<void>(WaitForExitStatus(pid));
+			return -1;
 		}
 
-		return GraphicMode() ? kdialogPresent : 0;
+		return pid;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	constexpr std::string_view XPropCmd = " --attach=$(sleep .01;printf \"%d\" $(xprop -root 32x '\t$0' _NET_ACTIVE_WINDOW | cut -f 2))";
-
-	//-------------------------------------------------------------------------------------------------------------------//
-
-	[[nodiscard]] CPP20Constexpr std::string GetKDialogFileCommandFilterPart(const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                                     const bool allFiles)
+	/// <summary>
+	/// Start a process through StartProcess() with its standard output connected to a new pipe.
+	/// </summary>
+	/// <param name="command">Argument vector, first element must be an absolute path.</param>
+	/// <param name="captureStderr">Whether to also redirect standard error into the pipe, otherwise it is discarded.</param>
+	/// <returns>Started process with the read end of the pipe or std::nullopt if it could not be started.</returns>
+	[[nodiscard]] std::optional<RunningProcess> SpawnProcess(const Command& command, const bool captureStderr = false)
 	{
-		std::string dialogString{};
+		std::array<int, 2> pipeFds{};
+		if(pipe2(pipeFds.data(), O_CLOEXEC) != 0)
+			return std::nullopt;
 
-		if(!filterPatterns.empty())
+		const int32_t stderrFd = captureStderr ? pipeFds[1] : open("/dev/null", O_WRONLY | O_CLOEXEC);
+		if(stderrFd < 0)
 		{
-			dialogString += " \"";
-			for(const auto& [name, extensions] : filterPatterns)
-			{
-				if(extensions.find(';') == std::string::npos)
-					dialogString += name + " (" + extensions + ")\n";
-				else
-				{
-					std::string exts = extensions;
-					std::replace(exts.begin(), exts.end(), ';', ' ');
-					dialogString += name + " (" + exts + ")\n";
-				}
-			}
+			close(pipeFds[0]);
+			close(pipeFds[1]);
+			return std::nullopt;
 		}
 
-		if(allFiles && filterPatterns.empty())
-			dialogString += "\"All Files (*.*)\"";
-		else if(allFiles && !filterPatterns.empty())
-			dialogString += "All Files (*.*)\"";
-		else if(!allFiles && !filterPatterns.empty())
+		const pid_t pid = StartProcess(command, -1, pipeFds[1], stderrFd);
+
+		close(pipeFds[1]);
+		if(!captureStderr)
+			close(stderrFd);
+
+		if(pid < 0)
 		{
-			dialogString.pop_back();
-			dialogString += "\"";
+			close(pipeFds[0]);
+			return std::nullopt;
 		}
 
-		return dialogString;
+		return RunningProcess{pid, pipeFds[0]};
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetKDialogBaseFileCommand(const std::string& title,
-		                                                const std::string& defaultPathAndFile,
-		                                                const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                const bool allFiles,
-													    const std::string& commandAction)
+	constexpr std::size_t InitialOutputCapacity = 4096;
+	std::atomic<std::size_t> MaxProcessOutputSize{64 * 1024 * 1024};
+
+	enum class ReadStatus
+	{
+		Data,
+		WouldBlock,
+		EndOfFile
+	};
+
+	/// <summary>
+	/// Read the output of a process from its pipe with a single read() call.<br>
+	/// The buffer doubles whenever it is full, up to the limit set by SetMaxDialogOutputSize().
+	/// Output beyond that limit is drained and discarded, so the process never blocks on a full pipe.
+	/// </summary>
+	/// <param name="fd">Read end of the pipe.</param>
+	/// <param name="output">Receives the data read.</param>
+	/// <returns>Whether data was read, no data is available right now or the pipe got closed (or failed).</returns>
+	[[nodiscard]] ReadStatus ReadProcessOutput(const int32_t fd, ProcessOutput& output)
 	{
-		std::string dialogString = "kdialog";
+		const std::size_t maxSize = MaxProcessOutputSize.load(std::memory_order_relaxed);
+		if(output.Size == output.Capacity && output.Capacity < maxSize)
+		{
+			const std::size_t capacity = std::min(std::max(output.Capacity * 2, InitialOutputCapacity), maxSize);
+			std::unique_ptr<char[]> data(new char[capacity]);
+			if(output.Size != 0)
+				std::memcpy(data.get(), output.Data.get(), output.Size);
 
-		if (KDialogPresent() == 2 && XPropPresent())
-			dialogString += XPropCmd;
+			output.Data = std::move(data);
+			output.Capacity = capacity;
+		}
 
-		dialogString += " " + commandAction + " ";
+		std::array<char, 4096> discard{};
+		const bool full = output.Size == output.Capacity;
+		char* const target = full ? discard.data() : output.Data.get() + output.Size;
+		const std::size_t space = full ? discard.size() : output.Capacity - output.Size;
 
-		if (!defaultPathAndFile.empty())
+		const ssize_t bytesRead = read(fd, target, space);
+		if(bytesRead > 0)
 		{
-			if (defaultPathAndFile[0] != '/')
-				dialogString += "$PWD/";
-			dialogString += "\"" + defaultPathAndFile + "\"";
+			if(full)
+				output.Truncated = true;
+			else
+				output.Size += static_cast<std::size_t>(bytesRead);
+			return ReadStatus::Data;
 		}
-		else
-			dialogString += "$PWD/";
-
-		dialogString += GetKDialogFileCommandFilterPart(filterPatterns, allFiles);
+		if(bytesRead < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+			return ReadStatus::WouldBlock;
 
-		if(!title.empty())
-			dialogString += " --title \"" + title + "\"";
-
-		return dialogString;
+		return ReadStatus::EndOfFile;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetKDialogSaveFileCommand(const std::string& title,
-		                                                const std::string& defaultPathAndFile,
-		                                                const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                const bool allFiles)
+	/// <summary>
+	/// Combine the output and exit status of a finished process.
+	/// </summary>
+	/// <returns>Result of the process or std::nullopt if its output got truncated.</returns>
+	[[nodiscard]] std::optional<ProcessResult> GetProcessResult(ProcessOutput output, const int32_t exitStatus)
 	{
-		return GetKDialogBaseFileCommand(title, defaultPathAndFile, filterPatterns, allFiles, "--getsavefilename");
+		//A cut off path list would silently miss selections, treat it like a failed dialog instead
+		if(output.Truncated)
+			return std::nullopt;
+
+		return ProcessResult{std::move(output), exitStatus};
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetKDialogOpenFileCommand(const std::string& title,
-		                                                const std::string& defaultPathAndFile,
-		                                                const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                const bool allowMultipleSelects,
-		                                                const bool allFiles)
+	/// <summary>
+	/// Run a process directly (without a shell) and collect its standard output.
+	/// </summary>
+	/// <param name="command">Argument vector, first element must be an absolute path.</param>
+	/// <param name="captureStderr">Whether to also collect standard error, otherwise it is discarded.</param>
+	/// <returns>Output and exit status of the process or std::nullopt if it could not be started.</returns>
+	[[nodiscard]] std::optional<ProcessResult> RunProcess(const Command& command, const bool captureStderr = false)
 	{
-		std::string dialogAction = "--getopenfilename";
-		if(allowMultipleSelects)
-			dialogAction += " --multiple --separate-output";
+		const std::optional<RunningProcess> process = SpawnProcess(command, captureStderr);
+		if(!process)
+			return std::nullopt;
 
-		return GetKDialogBaseFileCommand(title, defaultPathAndFile, filterPatterns, allFiles, dialogAction);
+		//The pipe is blocking, so this only returns early on EINTR
+		ProcessOutput output{};
+		while(ReadProcessOutput(process->OutputFd, output) != ReadStatus::EndOfFile)
+			;
+		close(process->OutputFd);
+
+		return GetProcessResult(std::move(output), WaitForExitStatus(process->Pid));
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] CPP20Constexpr std::string GetGenericFileCommandFilterPart(const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                                     const bool allFiles)
+	[[nodiscard]] bool ProbeXProp()
 	{
-		std::string dialogString{};
+		const TraceScope trace(MD::TracePhase::Detection, "xprop", "active window probe");
 
-		if(!filterPatterns.empty())
-		{
-			for(const auto& [name, extensions] : filterPatterns)
-			{
-				if(extensions.find(';') == std::string::npos)
-					dialogString += " --file-filter='" + name + " | " + extensions + "'";
-				else
-				{
-					std::string exts = extensions;
-					std::size_t index = 0;
-					while((index = exts.find(';')) != std::string::npos)
-						exts.replace(index, 1, " | ");
-					dialogString += " --file-filter='" + name + " | " + exts + "'";
-				}
-			}
-		}
+		if(GetCachedProbe(CachedProbe::XProp) > 0)
+			return true;
 
-		if(allFiles)
-			dialogString += " --file-filter='All Files | *'";
+		if(!RunProcess({GetExecutables().XProp, "-root", "32x", "\t$0", "_NET_ACTIVE_WINDOW"}))
+			return false;
 
-		return dialogString;
+		StoreCachedProbe(CachedProbe::XProp, 1);
+		return true;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetYadBaseFileCommand(const std::string& title,
-		                                            const std::string& defaultPathAndFile,
-		                                            const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                            const bool allFiles,
-													const std::string& commandAction)
+	[[nodiscard]] int32_t ProbeZenityVersion()
 	{
-		std::string dialogString = "yad " + commandAction;
+		const TraceScope trace(MD::TracePhase::Detection, "zenity", "version probe");
 
-		if(!title.empty())
-			dialogString += " --title=\"" + title + "\"";
+		int32_t zenity3Present = GetCachedProbe(CachedProbe::Zenity3);
+		if(zenity3Present >= 0)
+			return zenity3Present;
 
-		if(!defaultPathAndFile.empty())
-			dialogString += " --filename=\"" + defaultPathAndFile + "\"";
+		zenity3Present = 0;
+
+		const std::optional<ProcessResult> result = RunProcess({GetExecutables().Zenity, "--version"});
+		const std::string output = result ? std::string(result->Output.View()) : std::string{};
 
-		dialogString += GetGenericFileCommandFilterPart(filterPatterns, allFiles);
+		if(!output.empty() && std::stoi(output) >= 3)
+		{
+			zenity3Present = 3;
+			const int32_t temp = std::stoi(output.substr(output.find_first_not_of('.') + 2));
+			if(temp >= 18)
+				zenity3Present = 5;
+			else if(temp >= 10)
+				zenity3Present = 4;
+		}
+		else if(!output.empty() && (std::stoi(output) == 2) && (std::stoi(output.substr(output.find_first_not_of('.') + 2)) >= 32))
+			zenity3Present = 2;
 
-		dialogString += " 2>/dev/null ";
+		StoreCachedProbe(CachedProbe::Zenity3, zenity3Present);
 
-		return dialogString;
+		return zenity3Present;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetYadSaveFileCommand(const std::string& title,
-		                                            const std::string& defaultPathAndFile,
-		                                            const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                            const bool allFiles)
+	[[nodiscard]] bool ProbeTKinter3(const std::string& python3)
 	{
-		return GetYadBaseFileCommand(title, defaultPathAndFile, filterPatterns, allFiles, "--file --save --confirm-overwrite");
-	}
+		const TraceScope trace(MD::TracePhase::Detection, "tkinter3", "tkinter import probe");
 
-	//-------------------------------------------------------------------------------------------------------------------//
+		const int32_t cached = GetCachedProbe(CachedProbe::TKinter3);
+		if(cached >= 0)
+			return cached;
 
-	[[nodiscard]] std::string GetYadOpenFileCommand(const std::string& title,
-		                                            const std::string& defaultPathAndFile,
-		                                            const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-													const bool allowMultipleSelects,
-		                                            const bool allFiles)
-	{
-		std::string dialogAction = "--file";
-		if(allowMultipleSelects)
-			dialogAction += " --multiple";
+		const std::optional<ProcessResult> result = RunProcess({python3, "-S", "-c", "try:\n\timport tkinter;\n\tprint(1);\nexcept:\n\tpass"});
+		const bool tkinter3Present = result && !result->Output.View().empty();
 
-		return GetYadBaseFileCommand(title, defaultPathAndFile, filterPatterns, allFiles, dialogAction);
+		StoreCachedProbe(CachedProbe::TKinter3, tkinter3Present);
+
+		return tkinter3Present;
 	}
 
+
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] CPP20Constexpr std::string GetTKinter3FileCommandFilterPart(const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                                      const bool allFiles)
+	/// <summary>
+	/// Check whether KDialog should be used.
+	/// </summary>
+	/// <param name="zenityPresent">Whether Zenity is available as well.</param>
+	/// <returns>0 if unavailable, 1 if available, 2 if available and supports --attach.</returns>
+	[[nodiscard]] int32_t ProbeKDialog(const bool zenityPresent)
 	{
-		std::string dialogString{};
+		const TraceScope trace(MD::TracePhase::Detection, "kdialog", "--attach probe");
 
-		if(!filterPatterns.empty() && filterPatterns[0].second[filterPatterns[0].second.size() - 1] != '*')
+		if(zenityPresent)
 		{
-			dialogString += "filetypes=(";
-			for(const auto& [name, extensions] : filterPatterns)
+			//Only prefer KDialog over Zenity on Qt based desktops
+			auto desktopEnv = std::getenv("XDG_SESSION_DESKTOP");
+			if(!desktopEnv)
 			{
-				if(extensions.find(';') == std::string::npos)
-					dialogString += "('" + name + "',('" + extensions + "',)),";
-				else
+				desktopEnv = std::getenv("XDG_CURRENT_DESKTOP");
+				if(!desktopEnv)
 				{
-					std::string exts = extensions;
-					std::size_t index = 0;
-					while((index = exts.find(';')) != std::string::npos)
-						exts.replace(index, 1, "','");
-					dialogString += "('" + name + "',('" + exts + "',)),";
+					desktopEnv = std::getenv("DESKTOP_SESSION");
+
+					if(!desktopEnv)
+						return 0;
 				}
 			}
+			const std::string desktop(desktopEnv);
+			if(desktop.empty() || (desktop != "KDE" && desktop != "kde" && desktop != "lxqt" && desktop != "LXQT"))
+				return 0;
 		}
 
-		if(allFiles && !filterPatterns.empty())
-			dialogString += "('All Files','*'))";
-		else if(!allFiles && !filterPatterns.empty())
-			dialogString += ")";
+		if(GetExecutables().KDialog.empty())
+			return 0;
+
+		const int32_t cached = GetCachedProbe(CachedProbe::KDialog);
+		if(cached >= 0)
+			return cached;
+
+		int32_t kdialogPresent = 1;
 
-		return dialogString;
+		const std::optional<ProcessResult> result = RunProcess({GetExecutables().KDialog, "--attach"}, true);
+		if (result && result->Output.View().find("Unknown") == std::string_view::npos)
+			kdialogPresent = 2;
+
+		StoreCachedProbe(CachedProbe::KDialog, kdialogPresent);
+
+		return kdialogPresent;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetTKinter3SaveFileCommand(const std::string& title,
-		                                                 const std::string& defaultPathAndFile,
-		                                                 const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                 const bool allFiles)
+	struct DBusConnection;
+	struct DBusMessage;
+
+	/// <summary>
+	/// Same layout as DBusMessageIter from dbus/dbus-message.h, only ever accessed by libdbus.
+	/// </summary>
+	struct DBusMessageIter
+	{
+		void* Dummy1;
+		void* Dummy2;
+		uint32_t Dummy3;
+		int32_t Dummy4;
+		int32_t Dummy5;
+		int32_t Dummy6;
+		int32_t Dummy7;
+		int32_t Dummy8;
+		int32_t Dummy9;
+		int32_t Dummy10;
+		int32_t Dummy11;
+		int32_t Pad1;
+		void* Pad2;
+		void* Pad3;
+	};
+
+	constexpr int32_t DBusBusSession = 0;
+	constexpr int32_t DBusTimeoutDefault = -1;
+	constexpr int32_t DBusMessageTypeMethodReturn = 2;
+	constexpr int32_t DBusTypeInvalid = 0;
+	constexpr int32_t DBusTypeByte = 'y';
+	constexpr int32_t DBusTypeBoolean = 'b';
+	constexpr int32_t DBusTypeUInt32 = 'u';
+	constexpr int32_t DBusTypeString = 's';
+	constexpr int32_t DBusTypeObjectPath = 'o';
+	constexpr int32_t DBusTypeArray = 'a';
+	constexpr int32_t DBusTypeVariant = 'v';
+	constexpr int32_t DBusTypeStruct = 'r';
+	constexpr int32_t DBusTypeDictEntry = 'e';
+
+	/// <summary>
+	/// Functions of libdbus used by the portal backend.<br>
+	/// Errors are never requested (nullptr), failures are detected through the return values.
+	/// </summary>
+	struct DBusLibrary
 	{
-		std::string dialogString = Python3Name + " -S -c \"import tkinter;from tkinter import filedialog;root=tkinter.Tk();root.withdraw();";
+		uint32_t(*ThreadsInitDefault)();
+		DBusConnection*(*BusGetPrivate)(int32_t type, void* error);
+		void(*BusAddMatch)(DBusConnection* connection, const char* rule, void* error);
+		void(*ConnectionSetExitOnDisconnect)(DBusConnection* connection, uint32_t exitOnDisconnect);
+		void(*ConnectionClose)(DBusConnection* connection);
+		void(*ConnectionUnref)(DBusConnection* connection);
+		DBusMessage*(*ConnectionSendWithReplyAndBlock)(DBusConnection* connection, DBusMessage* message, int32_t timeout, void* error);
+		uint32_t(*ConnectionSend)(DBusConnection* connection, DBusMessage* message, uint32_t* serial);
+		void(*ConnectionFlush)(DBusConnection* connection);
+		uint32_t(*ConnectionReadWrite)(DBusConnection* connection, int32_t timeout);
+		DBusMessage*(*ConnectionPopMessage)(DBusConnection* connection);
+		uint32_t(*ConnectionGetUnixFd)(DBusConnection* connection, int* fd);
+		DBusMessage*(*MessageNewMethodCall)(const char* destination, const char* path, const char* interface, const char* method);
+		void(*MessageUnref)(DBusMessage* message);
+		uint32_t(*MessageIsSignal)(DBusMessage* message, const char* interface, const char* name);
+		const char*(*MessageGetPath)(DBusMessage* message);
+		int32_t(*MessageGetType)(DBusMessage* message);
+		uint32_t(*MessageGetReplySerial)(DBusMessage* message);
+		void(*MessageIterInitAppend)(DBusMessage* message, DBusMessageIter* iter);
+		uint32_t(*MessageIterAppendBasic)(DBusMessageIter* iter, int32_t type, const void* value);
+		uint32_t(*MessageIterAppendFixedArray)(DBusMessageIter* iter, int32_t elementType, const void* value, int32_t elements);
+		uint32_t(*MessageIterOpenContainer)(DBusMessageIter* iter, int32_t type, const char* signature, DBusMessageIter* sub);
+		uint32_t(*MessageIterCloseContainer)(DBusMessageIter* iter, DBusMessageIter* sub);
+		uint32_t(*MessageIterInit)(DBusMessage* message, DBusMessageIter* iter);
+		int32_t(*MessageIterGetArgType)(DBusMessageIter* iter);
+		void(*MessageIterGetBasic)(DBusMessageIter* iter, void* value);
+		void(*MessageIterRecurse)(DBusMessageIter* iter, DBusMessageIter* sub);
+		uint32_t(*MessageIterNext)(DBusMessageIter* iter);
+	};
+
+	using DBusMessagePtr = std::unique_ptr<DBusMessage, void(*)(DBusMessage*)>;
 
-		dialogString += "res=filedialog.asksaveasfilename(";
+	//-------------------------------------------------------------------------------------------------------------------//
 
-		if(!title.empty())
-			dialogString += "title='" + title + "',";
+	template<typename F>
+	[[nodiscard]] bool LoadSymbol(void* const library, const char* const name, F& function)
+	{
+		function = reinterpret_cast<F>(dlsym(library, name));
 
-		if(!defaultPathAndFile.empty())
-		{
-			std::string str = GetPathWithoutFinalSlash(defaultPathAndFile);
-			if(!str.empty())
-				dialogString += "initialdir='" + str + "',";
-			str = GetLastName(defaultPathAndFile);
-			if(!str.empty())
-				dialogString += "initialfile='" + str + "',";
-		}
+		return function != nullptr;
+	}
 
-		dialogString += GetTKinter3FileCommandFilterPart(filterPatterns, allFiles);
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Load libdbus on first use, it stays loaded afterwards.<br>
+	/// ModernDialogs doesn't link against libdbus, without it the portal backend is just unavailable.
+	/// </summary>
+	/// <returns>libdbus or nullptr if it is unavailable.</returns>
+	[[nodiscard]] const DBusLibrary* GetDBusLibrary()
+	{
+		static const std::optional<DBusLibrary> library = []() -> std::optional<DBusLibrary>
+		{
+			void* const handle = dlopen("libdbus-1.so.3", RTLD_LAZY | RTLD_LOCAL);
+			if(handle == nullptr)
+				return std::nullopt;
+
+			DBusLibrary dbus{};
+			const bool loaded = LoadSymbol(handle, "dbus_threads_init_default", dbus.ThreadsInitDefault) &&
+			                    LoadSymbol(handle, "dbus_bus_get_private", dbus.BusGetPrivate) &&
+			                    LoadSymbol(handle, "dbus_bus_add_match", dbus.BusAddMatch) &&
+			                    LoadSymbol(handle, "dbus_connection_set_exit_on_disconnect", dbus.ConnectionSetExitOnDisconnect) &&
+			                    LoadSymbol(handle, "dbus_connection_close", dbus.ConnectionClose) &&
+			                    LoadSymbol(handle, "dbus_connection_unref", dbus.ConnectionUnref) &&
+			                    LoadSymbol(handle, "dbus_connection_send_with_reply_and_block", dbus.ConnectionSendWithReplyAndBlock) &&
+			                    LoadSymbol(handle, "dbus_connection_send", dbus.ConnectionSend) &&
+			                    LoadSymbol(handle, "dbus_connection_flush", dbus.ConnectionFlush) &&
+			                    LoadSymbol(handle, "dbus_connection_read_write", dbus.ConnectionReadWrite) &&
+			                    LoadSymbol(handle, "dbus_connection_pop_message", dbus.ConnectionPopMessage) &&
+			                    LoadSymbol(handle, "dbus_connection_get_unix_fd", dbus.ConnectionGetUnixFd) &&
+			                    LoadSymbol(handle, "dbus_message_new_method_call", dbus.MessageNewMethodCall) &&
+			                    LoadSymbol(handle, "dbus_message_unref", dbus.MessageUnref) &&
+			                    LoadSymbol(handle, "dbus_message_is_signal", dbus.MessageIsSignal) &&
+			                    LoadSymbol(handle, "dbus_message_get_path", dbus.MessageGetPath) &&
+			                    LoadSymbol(handle, "dbus_message_get_type", dbus.MessageGetType) &&
+			                    LoadSymbol(handle, "dbus_message_get_reply_serial", dbus.MessageGetReplySerial) &&
+			                    LoadSymbol(handle, "dbus_message_iter_init_append", dbus.MessageIterInitAppend) &&
+			                    LoadSymbol(handle, "dbus_message_iter_append_basic", dbus.MessageIterAppendBasic) &&
+			                    LoadSymbol(handle, "dbus_message_iter_append_fixed_array", dbus.MessageIterAppendFixedArray) &&
+			                    LoadSymbol(handle, "dbus_message_iter_open_container", dbus.MessageIterOpenContainer) &&
+			                    LoadSymbol(handle, "dbus_message_iter_close_container", dbus.MessageIterCloseContainer) &&
+			                    LoadSymbol(handle, "dbus_message_iter_init", dbus.MessageIterInit) &&
+			                    LoadSymbol(handle, "dbus_message_iter_get_arg_type", dbus.MessageIterGetArgType) &&
+			                    LoadSymbol(handle, "dbus_message_iter_get_basic", dbus.MessageIterGetBasic) &&
+			                    LoadSymbol(handle, "dbus_message_iter_recurse", dbus.MessageIterRecurse) &&
+			                    LoadSymbol(handle, "dbus_message_iter_next", dbus.MessageIterNext);
+
+			//Dialogs run on several threads at once
+			if(!loaded || !dbus.ThreadsInitDefault())
+			{
+				dlclose(handle);
+				return std::nullopt;
+			}
 
-		dialogString += ");\nif not isinstance(res, tuple):\n\tprint(res)\n\"";
+			return dbus;
+		}();
 
-		return dialogString;
+		return library ? &*library : nullptr;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetTKinter3OpenFileCommand(const std::string& title,
-		                                                 const std::string& defaultPathAndFile,
-		                                                 const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-														 const bool allowMultipleSelects,
-		                                                 const bool allFiles)
+	//GNormalizeMode value of NFC (G_NORMALIZE_DEFAULT_COMPOSE)
+	constexpr int32_t GLibNormalizeNFC = 1;
+
+	/// <summary>
+	/// Unicode normalization functions of GLib.
+	/// </summary>
+	struct GLibNormalizer
 	{
-		std::string dialogString = Python3Name + " -S -c \"import tkinter;from tkinter import filedialog;root=tkinter.Tk();root.withdraw();";
+		char*(*Normalize)(const char* str, ssize_t len, int32_t mode);
+		void(*Free)(void* mem);
+	};
 
-		dialogString += "lFiles=filedialog.askopenfilename(";
+	//-------------------------------------------------------------------------------------------------------------------//
 
-		if(allowMultipleSelects)
-			dialogString += "multiple=1,";
+	/// <summary>
+	/// Load the normalization functions of GLib on first use, it stays loaded afterwards.<br>
+	/// ModernDialogs doesn't link against GLib, without it paths are just not normalized.
+	/// </summary>
+	/// <returns>GLib or nullptr if it is unavailable.</returns>
+	[[nodiscard]] const GLibNormalizer* GetGLibNormalizer()
+	{
+		static const std::optional<GLibNormalizer> library = []() -> std::optional<GLibNormalizer>
+		{
+			void* const handle = dlopen("libglib-2.0.so.0", RTLD_LAZY | RTLD_LOCAL);
+			if(handle == nullptr)
+				return std::nullopt;
 
-		if(!title.empty())
-			dialogString += "title='" + title + "',";
+			GLibNormalizer glib{};
+			if(!LoadSymbol(handle, "g_utf8_normalize", glib.Normalize) || !LoadSymbol(handle, "g_free", glib.Free))
+			{
+				dlclose(handle);
+				return std::nullopt;
+			}
 
-		if(!defaultPathAndFile.empty())
+			return glib;
+		}();
+
+		return library ? &*library : nullptr;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Private connection to the session bus, closed on destruction.<br>
+	/// Every dialog uses its own connection, so concurrent dialogs never consume each others messages.
+	/// </summary>
+	class DBusSession
+	{
+	public:
+		explicit DBusSession(const DBusLibrary& dbus)
+			: m_dbus(dbus), m_connection(dbus.BusGetPrivate(DBusBusSession, nullptr))
+		{
+			//libdbus calls _exit() on disconnect by default
+			if(m_connection != nullptr)
+				m_dbus.ConnectionSetExitOnDisconnect(m_connection, 0);
+		}
+
+		~DBusSession()
 		{
-			std::string tmp = GetPathWithoutFinalSlash(defaultPathAndFile);
-			if(!tmp.empty())
-				dialogString += "initialdir='" + tmp + "',";
-			tmp = GetLastName(defaultPathAndFile);
-			if(!tmp.empty())
-				dialogString += "initialfile='" + tmp + "',";
+			if(m_connection != nullptr)
+			{
+				m_dbus.ConnectionClose(m_connection);
+				m_dbus.ConnectionUnref(m_connection);
+			}
 		}
 
-		dialogString += GetTKinter3FileCommandFilterPart(filterPatterns, allFiles);
+		DBusSession(const DBusSession&) = delete;
+		DBusSession& operator=(const DBusSession&) = delete;
 
-		dialogString += ");\nif not isinstance(lFiles, tuple):\n\tprint(lFiles)\nelse:\n\tlFilesString=''\n\t";
-		dialogString += "for lFile in lFiles:\n\t\tlFilesString+=str(lFile)+'|'\n\tprint(lFilesString[:-1])\n\"";
+		[[nodiscard]] DBusConnection* Get() const
+		{
+			return m_connection;
+		}
 
-		return dialogString;
-	}
+	private:
+		const DBusLibrary& m_dbus;
+		DBusConnection* m_connection;
+	};
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetGenericBaseFileCommandPart(const std::string& title,
-		                                                    const std::string& defaultPathAndFile,
-		                                                    const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                    const bool allFiles)
+	constexpr const char* PortalService = "org.freedesktop.portal.Desktop";
+	constexpr const char* PortalObject = "/org/freedesktop/portal/desktop";
+	constexpr const char* PortalFileChooserInterface = "org.freedesktop.portal.FileChooser";
+	constexpr const char* PortalRequestInterface = "org.freedesktop.portal.Request";
+	//Generous as the portal service may have to be started first
+	constexpr int32_t PortalProbeTimeoutMilliseconds = 2000;
+
+	/// <summary>
+	/// Query the version of the FileChooser portal, which starts the portal service if needed.<br>
+	/// Only an available portal is stored in the detection cache, a service which didn't answer in time gets probed again.
+	/// </summary>
+	/// <returns>Version of the portal or 0 if it is unavailable.</returns>
+	[[nodiscard]] uint32_t ProbePortalFileChooser()
 	{
-		std::string dialogString{};
+		const TraceScope trace(MD::TracePhase::Detection, "portal", "FileChooser version probe");
 
-		if(!title.empty())
-			dialogString += " --title=\"" + title + "\"";
-		if(!defaultPathAndFile.empty())
-			dialogString += " --filename=\"" + defaultPathAndFile + "\"";
-		dialogString += GetGenericFileCommandFilterPart(filterPatterns, allFiles);
-		dialogString += " 2>/dev/null ";
+		if(const int32_t cached = GetCachedProbe(CachedProbe::Portal); cached > 0)
+			return static_cast<uint32_t>(cached);
+
+		const DBusLibrary* const dbus = GetDBusLibrary();
+		if(dbus == nullptr)
+			return 0;
+
+		const DBusSession session(*dbus);
+		if(session.Get() == nullptr)
+			return 0;
+
+		const DBusMessagePtr call(dbus->MessageNewMethodCall(PortalService, PortalObject, "org.freedesktop.DBus.Properties", "Get"), dbus->MessageUnref);
+		if(!call)
+			return 0;
+
+		DBusMessageIter args{};
+		dbus->MessageIterInitAppend(call.get(), &args);
+		const char* const interface = PortalFileChooserInterface;
+		const char* const property = "version";
+		if(!dbus->MessageIterAppendBasic(&args, DBusTypeString, &interface) || !dbus->MessageIterAppendBasic(&args, DBusTypeString, &property))
+			return 0;
+
+		const DBusMessagePtr reply(dbus->ConnectionSendWithReplyAndBlock(session.Get(), call.get(), PortalProbeTimeoutMilliseconds, nullptr), dbus->MessageUnref);
+		DBusMessageIter result{};
+		if(!reply || !dbus->MessageIterInit(reply.get(), &result) || dbus->MessageIterGetArgType(&result) != DBusTypeVariant)
+			return 0;
+
+		DBusMessageIter value{};
+		dbus->MessageIterRecurse(&result, &value);
+		if(dbus->MessageIterGetArgType(&value) != DBusTypeUInt32)
+			return 0;
+
+		uint32_t version = 0;
+		dbus->MessageIterGetBasic(&value, &version);
 
-		return dialogString;
+		if(version > 0)
+			StoreCachedProbe(CachedProbe::Portal, static_cast<int32_t>(std::min<uint32_t>(version, std::numeric_limits<int32_t>::max())));
+
+		return version;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetGenericSaveFileCommandPart(const std::string& title,
-		                                                    const std::string& defaultPathAndFile,
-		                                                    const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                    const bool allFiles)
+	/// <summary>
+	/// Functions of libX11 used to query the active window.
+	/// </summary>
+	struct X11Library
 	{
-		return " --file-selection --save --confirm-overwrite" + GetGenericBaseFileCommandPart(title, defaultPathAndFile, filterPatterns, allFiles);
-	}
+		void*(*OpenDisplay)(const char* name);
+		unsigned long(*InternAtom)(void* display, const char* name, int32_t onlyIfExists);
+		unsigned long(*DefaultRootWindow)(void* display);
+		int32_t(*GetWindowProperty)(void* display, unsigned long window, unsigned long property, long offset, long length, int32_t remove,
+		                            unsigned long requestedType, unsigned long* actualType, int* actualFormat, unsigned long* items,
+		                            unsigned long* bytesAfter, unsigned char** data);
+		int32_t(*Free)(void* data);
+	};
+
+	//XA_WINDOW from X11/Xatom.h
+	constexpr unsigned long X11AtomWindow = 33;
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetGenericOpenFileCommandPart(const std::string& title,
-		                                                    const std::string& defaultPathAndFile,
-		                                                    const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-															const bool allowMultipleSelects,
-		                                                    const bool allFiles)
+	/// <summary>
+	/// Load libX11 on first use, it stays loaded afterwards.<br>
+	/// ModernDialogs doesn't link against libX11, without it the active window is queried through xprop.
+	/// </summary>
+	/// <returns>libX11 or nullptr if it is unavailable.</returns>
+	[[nodiscard]] const X11Library* GetX11Library()
 	{
-		std::string dialogAction = " --file-selection";
-		if(allowMultipleSelects)
-			dialogAction += " --multiple";
+		static const std::optional<X11Library> library = []() -> std::optional<X11Library>
+		{
+			void* const handle = dlopen("libX11.so.6", RTLD_LAZY | RTLD_LOCAL);
+			if(handle == nullptr)
+				return std::nullopt;
+
+			X11Library x11{};
+			const bool loaded = LoadSymbol(handle, "XOpenDisplay", x11.OpenDisplay) &&
+			                    LoadSymbol(handle, "XInternAtom", x11.InternAtom) &&
+			                    LoadSymbol(handle, "XDefaultRootWindow", x11.DefaultRootWindow) &&
+			                    LoadSymbol(handle, "XGetWindowProperty", x11.GetWindowProperty) &&
+			                    LoadSymbol(handle, "XFree", x11.Free);
+			if(!loaded)
+			{
+				dlclose(handle);
+				return std::nullopt;
+			}
 
-		return dialogAction + GetGenericBaseFileCommandPart(title, defaultPathAndFile, filterPatterns, allFiles);
+			return x11;
+		}();
+
+		return library ? &*library : nullptr;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetZenitySaveFileCommand(const std::string& title,
-		                                               const std::string& defaultPathAndFile,
-		                                               const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                               const bool allFiles)
+	/// <summary>
+	/// Immutable description of the detected dialog backends.<br>
+	/// Backends are probed in order of preference and probing stops at the first available one,
+	/// so the flags of less preferred backends may stay false even if they are installed.
+	/// </summary>
+	struct BackendInfo
 	{
-		std::string dialogString = "zenity ";
-		if(Zenity3Present() >= 4 && XPropPresent())
-			dialogString += XPropCmd;
-
-		return dialogString + GetGenericSaveFileCommandPart(title, defaultPathAndFile, filterPatterns, allFiles);
-	}
+		int32_t EnvDISPLAY = 0;
+		bool Darwin = false;
+		bool GraphicMode = false;
+
+		int32_t KDialog = 0;
+		bool Zenity = false;
+		int32_t Zenity3 = 0;
+		bool MateDialog = false;
+		bool Shellementary = false;
+		bool Qarma = false;
+		bool Yad = false;
+		bool TKinter3 = false;
+		bool XProp = false;
+		//libX11 could be loaded, the active window is queried in-process instead of through xprop
+		bool X11 = false;
+		//Version of the FileChooser portal, 0 if unavailable
+		uint32_t Portal = 0;
+
+		std::string Python3{};
+	};
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetZenityOpenFileCommand(const std::string& title,
-		                                               const std::string& defaultPathAndFile,
-		                                               const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-													   const bool allowMultipleSelects,
-		                                               const bool allFiles)
+	[[nodiscard]] BackendInfo DetectBackendInfo()
 	{
-		std::string dialogString = "zenity";
-		if(Zenity3Present() >= 4 && XPropPresent())
-			dialogString += XPropCmd;
+		BackendInfo info{};
+
+		info.EnvDISPLAY = DetectEnvDISPLAY();
+		info.Darwin = DetectDarwin();
+		info.GraphicMode = info.EnvDISPLAY || (info.Darwin && info.EnvDISPLAY);
+
+		//Without a display no backend is able to show anything
+		if(!info.GraphicMode)
+			return info;
+
+		const ExecutablePaths& executables = GetExecutables();
+
+		info.Zenity = !executables.Zenity.empty();
+		info.KDialog = ProbeKDialog(info.Zenity);
+		if(info.KDialog)
+			info.Zenity = false;
+		else if(info.Zenity)
+			info.Zenity3 = ProbeZenityVersion();
+		else if(!executables.MateDialog.empty())
+			info.MateDialog = true;
+		else if(!executables.Shellementary.empty())
+			info.Shellementary = true;
+		else if(!executables.Qarma.empty())
+			info.Qarma = true;
+		else if(!executables.Yad.empty())
+			info.Yad = true;
+		else if(!executables.Python3.empty() && !info.Darwin)
+		{
+			info.TKinter3 = ProbeTKinter3(executables.Python3);
+			info.Python3 = executables.Python3;
+		}
+
+		//Wayland sessions prefer the portal for file dialogs, it runs in-process and uses the native dialog of the desktop
+		if(info.EnvDISPLAY & 2)
+			info.Portal = ProbePortalFileChooser();
 
-		return dialogString + GetGenericOpenFileCommandPart(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
+		//Only KDialog, Zenity >= 3.10 and Qarma are able to attach to the active window
+		const bool attaches = info.KDialog == 2 || info.Zenity3 >= 4 || info.Qarma;
+		if(attaches && (info.EnvDISPLAY & 1))
+		{
+			info.X11 = GetX11Library() != nullptr;
+			if(!info.X11 && !executables.XProp.empty())
+				info.XProp = ProbeXProp();
+		}
+
+		return info;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetMateDialogSaveFileCommand(const std::string& title,
-		                                                   const std::string& defaultPathAndFile,
-		                                                   const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                   const bool allFiles)
+	/// <summary>
+	/// Retrieve the backend description, detecting it on first use.<br>
+	/// The description is published exactly once through a thread-safe static initialization
+	/// (the compiler emits the equivalent of std::call_once with acquire/release semantics),
+	/// concurrent callers block until the detection has finished and read it without locking afterwards.
+	/// </summary>
+	[[nodiscard]] const BackendInfo& GetBackendInfo()
 	{
-		return std::string("matedialog") + GetGenericSaveFileCommandPart(title, defaultPathAndFile, filterPatterns, allFiles);
+		static const BackendInfo info = DetectBackendInfo();
+
+		return info;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetMateDialogOpenFileCommand(const std::string& title,
-		                                                   const std::string& defaultPathAndFile,
-		                                                   const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-														   const bool allowMultipleSelects,
-		                                                   const bool allFiles)
+	/// <summary>
+	/// Whether the window to attach dialogs to can be determined.
+	/// </summary>
+	[[nodiscard]] bool CanAttachToWindow()
 	{
-		return std::string("matedialog") + GetGenericOpenFileCommandPart(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
+		const BackendInfo& info = GetBackendInfo();
+
+		return ParentWindow != 0 || info.X11 || info.XProp;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetShellementarySaveFileCommand(const std::string& title,
-		                                                      const std::string& defaultPathAndFile,
-		                                                      const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                                      const bool allFiles)
+	[[nodiscard]] int32_t Zenity3Present()
 	{
-		return std::string("shellementary") + GetGenericSaveFileCommandPart(title, defaultPathAndFile, filterPatterns, allFiles);
+		return GetBackendInfo().Zenity3;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetShellementaryOpenFileCommand(const std::string& title,
-		                                                      const std::string& defaultPathAndFile,
-		                                                      const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-															  const bool allowMultipleSelects,
-		                                                      const bool allFiles)
+	[[nodiscard]] int32_t KDialogPresent()
 	{
-		return std::string("shellementary") + GetGenericOpenFileCommandPart(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
+		return GetBackendInfo().KDialog;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetQarmaSaveFileCommand(const std::string& title,
-		                                              const std::string& defaultPathAndFile,
-		                                              const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-		                                              const bool allFiles)
-	{
-		std::string dialogString = "qarma";
-		if(XPropPresent())
-			dialogString += XPropCmd;
-
-		return dialogString + GetGenericSaveFileCommandPart(title, defaultPathAndFile, filterPatterns, allFiles);
-	}
+	std::mutex PrewarmMutex{};
+	std::shared_future<void> PrewarmFuture{};
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetQarmaOpenFileCommand(const std::string& title,
-		                                              const std::string& defaultPathAndFile,
-		                                              const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-													  const bool allowMultipleSelects,
-		                                              const bool allFiles)
+	/// <summary>
+	/// Read _NET_ACTIVE_WINDOW of the root window through libX11.<br>
+	/// The display connection is opened once and only used while holding the mutex,
+	/// so Xlib doesn't need to be initialized for threads.
+	/// </summary>
+	/// <returns>Id of the active window or 0 if it is unknown.</returns>
+	[[nodiscard]] uint64_t QueryActiveWindow()
 	{
-		std::string dialogString = "qarma";
-		if(XPropPresent())
-			dialogString += XPropCmd;
+		const X11Library* const x11 = GetX11Library();
+		if(x11 == nullptr)
+			return 0;
 
-		return dialogString + GetGenericOpenFileCommandPart(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	}
+		static std::mutex displayMutex{};
+		static void* display = nullptr;
+		static unsigned long activeWindowAtom = 0;
 
-	//-------------------------------------------------------------------------------------------------------------------//
+		const std::lock_guard lock(displayMutex);
+		if(display == nullptr)
+		{
+			display = x11->OpenDisplay(nullptr);
+			if(display == nullptr)
+				return 0;
+			activeWindowAtom = x11->InternAtom(display, "_NET_ACTIVE_WINDOW", 1);
+		}
+		//Window managers without EWMH support don't know the atom
+		if(activeWindowAtom == 0)
+			return 0;
 
-	[[nodiscard]] std::string GetGenericSelectFolderCommandPart(const std::string& title, const std::string& defaultPath)
-	{
-		return " --file-selection --directory" + GetGenericBaseFileCommandPart(title, defaultPath, {}, false);
+		unsigned long actualType = 0;
+		int actualFormat = 0;
+		unsigned long items = 0;
+		unsigned long bytesAfter = 0;
+		unsigned char* data = nullptr;
+		const int32_t status = x11->GetWindowProperty(display, x11->DefaultRootWindow(display), activeWindowAtom, 0, 1, 0, X11AtomWindow,
+		                                              &actualType, &actualFormat, &items, &bytesAfter, &data);
+
+		uint64_t windowId = 0;
+		//Xlib returns 32 bit properties as an array of long
+		if(status == 0 && data != nullptr && actualType == X11AtomWindow && actualFormat == 32 && items == 1)
+			windowId = *reinterpret_cast<const unsigned long*>(data);
+		if(data != nullptr)
+			x11->Free(data);
+
+		return windowId;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetZenitySelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	/// <summary>
+	/// Query the active window, so dialogs can attach to it.<br>
+	/// A parent window set through MD::SetParentWindow() takes precedence,
+	/// otherwise libX11 is used and xprop only if libX11 is unavailable.
+	/// </summary>
+	/// <returns>Decimal window id or empty string.</returns>
+	[[nodiscard]] std::string GetActiveWindowId()
 	{
-		std::string dialogString = "zenity";
-		if(Zenity3Present() >= 4 && XPropPresent())
-			dialogString += XPropCmd;
+		const uint64_t parentWindow = ParentWindow;
+		if(parentWindow != 0)
+			return std::to_string(parentWindow);
+
+		if(GetBackendInfo().X11)
+		{
+			const uint64_t windowId = QueryActiveWindow();
+			return windowId != 0 ? std::to_string(windowId) : "";
+		}
+
+		const std::optional<ProcessResult> result = RunProcess({GetExecutables().XProp, "-root", "32x", "\t$0", "_NET_ACTIVE_WINDOW"});
+		if(!result)
+			return "";
+
+		//Output looks like "_NET_ACTIVE_WINDOW\t0x3a00007"
+		const std::string_view output = result->Output.View();
+		const std::size_t tab = output.find('\t');
+		if(tab == std::string_view::npos)
+			return "";
+
+		const unsigned long long windowId = std::strtoull(std::string(output.substr(tab + 1)).c_str(), nullptr, 0);
+		if(windowId == 0)
+			return "";
 
-		return dialogString + GetGenericSelectFolderCommandPart(title, defaultPath);
+		return std::to_string(windowId);
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetMateDialogSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	//Window id the command built last on this thread attaches to, std::nullopt if it doesn't attach, see ReusableDialog
+	thread_local std::optional<std::string> AttachedWindowId{};
+
+	void AppendAttachArgument(Command& command)
 	{
-		return "matedialog" + GetGenericSelectFolderCommandPart(title, defaultPath);
+		const std::string windowId = GetActiveWindowId();
+		AttachedWindowId = windowId;
+		if(!windowId.empty())
+			command.push_back("--attach=" + windowId);
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetShellementarySelectFolderCommand(const std::string& title, const std::string& defaultPath)
-	{
-		return "shellementary" + GetGenericSelectFolderCommandPart(title, defaultPath);
-	}
+	/// <summary>
+	/// Upper bound for the rendered filters of a dialog.<br>
+	/// Linux refuses single arguments larger than 128 KiB (MAX_ARG_STRLEN), patterns exceeding the bound are left out.
+	/// </summary>
+	constexpr std::size_t MaxFilterPartSize = 64u * 1024u;
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetQarmaSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	/// <summary>
+	/// Append the patterns of a filter joined by separator, as long as out doesn't grow beyond limit.<br>
+	/// The patterns are appended through append if given, e.g. to escape them.
+	/// </summary>
+	/// <returns>Number of appended patterns.</returns>
+	std::size_t AppendFilterPatterns(std::string& out,
+	                                 const std::vector<std::string_view>& patterns,
+	                                 const std::string_view separator,
+	                                 const std::size_t limit,
+	                                 void(*const append)(std::string&, std::string_view) = nullptr)
 	{
-		std::string dialogString = "qarma";
-		if(XPropPresent())
-			dialogString += XPropCmd;
+		std::size_t count = 0;
+
+		for(const std::string_view pattern : patterns)
+		{
+			const std::size_t size = (count != 0 ? separator.size() : 0) + pattern.size();
+			if(out.size() + size > limit)
+				break;
+
+			const std::size_t start = out.size();
+			if(count != 0)
+				out += separator;
+			if(append == nullptr)
+				out += pattern;
+			else
+			{
+				append(out, pattern);
+				//Escaping may have grown the pattern past the limit
+				if(out.size() > limit)
+				{
+					out.resize(start);
+					break;
+				}
+			}
+			++count;
+		}
 
-		return dialogString + GetGenericSelectFolderCommandPart(title, defaultPath);
+		return count;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetKDialogSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	/// <summary>
+	/// Estimated size of the rendered filters, each pattern and filter adding up to overhead bytes.
+	/// </summary>
+	[[nodiscard]] std::size_t GetFilterPartSizeHint(const MD::FilterSet::Data& filters, const std::size_t overhead)
 	{
-		return GetKDialogBaseFileCommand(title, defaultPath, {}, false, "--getexistingdirectory");
+		const std::size_t size = filters.TextSize + (filters.PatternCount + filters.Filters.size()) * overhead + 32u;
+		return std::min(size, MaxFilterPartSize + 32u);
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetYadSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	/// <summary>
+	/// Empty filters without "All Files", used by the folder selections.
+	/// </summary>
+	[[nodiscard]] const MD::FilterSet::Data& GetNoFilters()
 	{
-		return GetYadBaseFileCommand(title, defaultPath, {}, false, "--file --directory");
+		static const MD::FilterSet::Data noFilters{{}, {}, 0, 0, false};
+		return noFilters;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetTKinter3SelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	[[nodiscard]] const std::string& GetKDialogFileCommandFilterPart(const MD::FilterSet::Data& filters)
 	{
-		std::string dialogString = Python3Name;
-		dialogString += " -S -c \"import tkinter;from tkinter import filedialog;root=tkinter.Tk();root.withdraw();";
-		dialogString += "res=filedialog.askdirectory(";
-		if(!title.empty())
-			dialogString += "title='" + title + "',";
-		if(!defaultPath.empty())
-			dialogString += "initialdir='" + defaultPath + "'";
-		dialogString += ");\nif not isinstance(res, tuple):\n\tprint(res)\n\"";
+		std::call_once(filters.KDialogOnce, [&filters]
+		{
+			std::string& filter = filters.KDialog;
+			filter.reserve(GetFilterPartSizeHint(filters, 4));
 
-		return dialogString;
+			for(std::size_t i = 0; i < filters.Filters.size(); ++i)
+			{
+				const std::size_t start = filter.size();
+				filter += filters.Filters[i].first;
+				filter += " (";
+				if(AppendFilterPatterns(filter, filters.Patterns[i], " ", MaxFilterPartSize - 2) == 0)
+				{
+					filter.resize(start);
+					break;
+				}
+				filter += ")\n";
+			}
+
+			if(filters.AllFiles)
+				filter += "All Files (*.*)";
+			else if(!filter.empty())
+				filter.pop_back();
+		});
+
+		return filters.KDialog;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetKDialogMsgBoxCommand(const std::string& title,
-													  const std::string& message,
-													  const MD::Style style,
-													  const MD::Buttons buttons)
+	[[nodiscard]] Command GetKDialogBaseFileCommand(const std::string& title,
+		                                            const std::string& defaultPathAndFile,
+		                                            const MD::FilterSet::Data& filters,
+		                                            const CommandAction commandAction)
 	{
-		std::string dialogString = "kdialog";
-		if (KDialogPresent() == 2 && XPropPresent())
-			dialogString += XPropCmd;
+		Command command{};
+		command.reserve(6 + commandAction.size());
+		command.push_back(GetExecutables().KDialog);
 
-		dialogString += " --";
-		if (buttons == MD::Buttons::OKCancel || buttons == MD::Buttons::YesNo)
+		if (KDialogPresent() == 2 && CanAttachToWindow())
+			AppendAttachArgument(command);
+
+		command.insert(command.end(), commandAction.begin(), commandAction.end());
+
+		std::string startPath{};
+		if (defaultPathAndFile.empty() || defaultPathAndFile[0] != '/')
 		{
-			if (style == MD::Style::Warning || style == MD::Style::Error)
-				dialogString += "warning";
-            dialogString += "yesno";
+			std::error_code ec{};
+			const std::filesystem::path currentPath = std::filesystem::current_path(ec);
+			startPath.reserve(currentPath.native().size() + 1 + defaultPathAndFile.size());
+			startPath += currentPath.native();
+			startPath += '/';
 		}
-		else if (style == MD::Style::Error)
-			dialogString += "error";
-		else if (style == MD::Style::Warning)
-			dialogString += "sorry";
-		else
-			dialogString += "msgbox";
-		dialogString += " \"";
-		if (!message.empty())
-			dialogString += message;
-		dialogString += "\"";
-		if (buttons == MD::Buttons::OKCancel)
-			dialogString += " --yes-label OK --no-label Cancel";
-        if (buttons == MD::Buttons::Quit)
-            dialogString += " --ok-label Quit";
-		if (!title.empty())
-			dialogString += " --title \"" + title + "\"";
+		startPath += defaultPathAndFile;
+		command.push_back(std::move(startPath));
+
+		std::string filter = GetKDialogFileCommandFilterPart(filters);
+		if(!filter.empty())
+			command.push_back(std::move(filter));
 
-		dialogString += ";if [ $? = 0 ];then echo 1;else echo 0;fi";
+		if(!title.empty())
+		{
+			command.push_back("--title");
+			command.push_back(title);
+		}
 
-		return dialogString;
+		return command;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetYadMsgBoxCommand(const std::string& title,
-		                                          const std::string& message,
-		                                          const MD::Style style,
-		                                          const MD::Buttons buttons)
+	[[nodiscard]] Command GetKDialogSaveFileCommand(const std::string& title,
+		                                            const std::string& defaultPathAndFile,
+		                                            const MD::FilterSet::Data& filters)
 	{
-		std::string dialogString = "szAnswer=$(yad --";
-
-        if(buttons == MD::Buttons::OK)
-            dialogString += "button=OK:1";
-        else if(buttons == MD::Buttons::OKCancel)
-            dialogString += "button=OK:1 --button=Cancel:0";
-        else if(buttons == MD::Buttons::YesNo)
-            dialogString += "button=Yes:1 --button=No:0";
-        else if(style == MD::Style::Error)
-            dialogString += "error";
-        else if(style == MD::Style::Warning)
-            dialogString += "warning";
-        else if(style == MD::Style::Question)
-            dialogString += "question";
-        else
-            dialogString += "info";
-
-        if(!title.empty())
-            dialogString += " --title=\"" + title + "\"";
-        if(!message.empty())
-            dialogString += " --text=\"" + message + "\"";
-
-		dialogString += " --image=dialog-";
-		if(style == MD::Style::Error)
-			dialogString += "error";
-		else if(style == MD::Style::Warning)
-			dialogString += "warning";
-		else if(style == MD::Style::Question)
-			dialogString += "question";
-		else
-			dialogString += "information";
-
-        dialogString += " 2>/dev/null ";
-        dialogString += ");echo $?";
-
-		return dialogString;
+		return GetKDialogBaseFileCommand(title, defaultPathAndFile, filters, {"--getsavefilename"});
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetTKinter3MsgBoxCommand(const std::string& title,
-		                                               const std::string& message,
-		                                               const MD::Style style,
-		                                               const MD::Buttons buttons)
+	[[nodiscard]] Command GetKDialogOpenFileCommand(const std::string& title,
+		                                            const std::string& defaultPathAndFile,
+		                                            const MD::FilterSet::Data& filters,
+		                                            const bool allowMultipleSelects)
 	{
-		std::string dialogString = Python3Name;
-
-		dialogString += " -S -c \"import tkinter;from tkinter import messagebox;root=tkinter.Tk();root.withdraw();";
-		dialogString += "res=messagebox.";
-
-		if(buttons == MD::Buttons::OKCancel)
-			dialogString += "askokcancel(";
-		else if(buttons == MD::Buttons::YesNo)
-			dialogString += "askyesno(";
-		else
-			dialogString += "showinfo(";
-
-		dialogString += "icon='";
+		if(allowMultipleSelects)
+			return GetKDialogBaseFileCommand(title, defaultPathAndFile, filters, {"--getopenfilename", "--multiple", "--separate-output"});
 
-		if(style == MD::Style::Error)
-			dialogString += "error";
-		else if(style == MD::Style::Question)
-			dialogString += "question";
-		else if(style == MD::Style::Warning)
-			dialogString += "warning";
-		else
-			dialogString += "info";
+		return GetKDialogBaseFileCommand(title, defaultPathAndFile, filters, {"--getopenfilename"});
+	}
 
-		dialogString += "',";
+	//-------------------------------------------------------------------------------------------------------------------//
 
-		if(!title.empty())
-			dialogString += "title='" + title + "',";
-		if(!message.empty())
+	void AppendGenericFileCommandFilterPart(Command& command, const MD::FilterSet::Data& filters)
+	{
+		std::call_once(filters.GenericOnce, [&filters]
 		{
-			std::string msg = message;
-			std::size_t p = std::string::npos;
-			while((p = msg.find('\n')) != std::string::npos)
-				msg.replace(p, 1, "\\n");
+			std::vector<std::string>& arguments = filters.Generic;
+			arguments.reserve(filters.Filters.size() + 1);
 
-			dialogString += "message='" + msg + "'";
-		}
+			std::size_t used = 0;
+			for(std::size_t i = 0; i < filters.Filters.size(); ++i)
+			{
+				std::string argument = "--file-filter=";
+				argument.reserve(argument.size() + filters.Filters[i].first.size() + filters.Filters[i].second.size() * 3 + 3);
+				argument += filters.Filters[i].first;
+				argument += " | ";
+				if(AppendFilterPatterns(argument, filters.Patterns[i], " | ", MaxFilterPartSize - used) == 0)
+					break;
+
+				used += argument.size();
+				arguments.push_back(std::move(argument));
+			}
 
-		dialogString += ");\nif res is False :\n\tprint (0)\nelse :\n\tprint (1)\n\"";
+			if(filters.AllFiles)
+				arguments.emplace_back("--file-filter=All Files | *");
+		});
 
-		return dialogString;
+		command.insert(command.end(), filters.Generic.begin(), filters.Generic.end());
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetGenericMsgBoxCommandPart(const std::string& title,
-		                                                  const std::string& message,
-		                                                  const MD::Style style,
-		                                                  const MD::Buttons buttons,
-														  const std::string& commandAction,
-														  const std::string& iconCommand = "")
+	[[nodiscard]] Command GetYadBaseFileCommand(const std::string& title,
+		                                        const std::string& defaultPathAndFile,
+		                                        const MD::FilterSet::Data& filters,
+		                                        const CommandAction commandAction)
 	{
-		std::string dialogString = "szAnswer=$(" + commandAction + " --";
-
-		if(buttons == MD::Buttons::OKCancel)
-            dialogString += "question --ok-label=OK --cancel-label=Cancel";
-        else if(buttons == MD::Buttons::YesNo)
-            dialogString += "question";
-        else if(style == MD::Style::Error)
-            dialogString += "error";
-        else if(style == MD::Style::Warning)
-            dialogString += "warning";
-        else
-            dialogString += "info";
-
-		if(buttons == MD::Buttons::Quit)
-            dialogString += " --ok-label=Quit";
+		Command command{};
+		command.reserve(4 + commandAction.size() + filters.Filters.size());
+		command.push_back(GetExecutables().Yad);
+		command.insert(command.end(), commandAction.begin(), commandAction.end());
 
 		if(!title.empty())
-			dialogString += " --title=\"" + title + "\"";
-		if(!message.empty())
-			dialogString += " --text=\"" + message + "\"";
+			command.push_back("--title=" + title);
 
-		dialogString += iconCommand;
+		if(!defaultPathAndFile.empty())
+			command.push_back("--filename=" + defaultPathAndFile);
 
-		dialogString += " 2>/dev/null ";
-		dialogString += ");if [ $? = 0 ];then echo 1;else echo 0;fi";
+		AppendGenericFileCommandFilterPart(command, filters);
 
-		return dialogString;
+		return command;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetGenericMsgBoxIconCommandPart(const MD::Style style)
+	[[nodiscard]] Command GetYadSaveFileCommand(const std::string& title,
+		                                        const std::string& defaultPathAndFile,
+		                                        const MD::FilterSet::Data& filters)
 	{
-		std::string dialogString = " --icon-name=dialog-";
-		if(style == MD::Style::Question)
-			dialogString += "question";
-		else if(style == MD::Style::Error)
-			dialogString += "error";
-		else if(style == MD::Style::Warning)
-			dialogString += "warning";
-		else
-			dialogString += "information";
-
-		return dialogString;
+		return GetYadBaseFileCommand(title, defaultPathAndFile, filters, {"--file", "--save", "--confirm-overwrite"});
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetZenityMsgBoxCommand(const std::string& title,
-		                                             const std::string& message,
-		                                             const MD::Style style,
-		                                             const MD::Buttons buttons)
+	[[nodiscard]] Command GetYadOpenFileCommand(const std::string& title,
+		                                        const std::string& defaultPathAndFile,
+		                                        const MD::FilterSet::Data& filters,
+		                                        const bool allowMultipleSelects)
 	{
-		std::string commandAction = "zenity";
-		if(Zenity3Present() >= 4 && XPropPresent())
-			commandAction += XPropCmd;
+		if(allowMultipleSelects)
+			return GetYadBaseFileCommand(title, defaultPathAndFile, filters, {"--file", "--multiple", "--separator=\n"});
 
-		return GetGenericMsgBoxCommandPart(title, message, style, buttons, commandAction, GetGenericMsgBoxIconCommandPart(style));
+		return GetYadBaseFileCommand(title, defaultPathAndFile, filters, {"--file"});
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetMateDialogMsgBoxCommand(const std::string& title,
-		                                                 const std::string& message,
-		                                                 const MD::Style style,
-		                                                 const MD::Buttons buttons)
+	[[nodiscard]] const std::string& GetTKinter3FileCommandFilterPart(const MD::FilterSet::Data& filters)
 	{
-		return GetGenericMsgBoxCommandPart(title, message, style, buttons, "matedialog");
+		std::call_once(filters.TKinterOnce, [&filters]
+		{
+			//A leading catch-all filter lets tkinter fall back to its own file types
+			if(filters.Filters.empty() || filters.Filters[0].second.back() == '*')
+				return;
+
+			std::string& dialogString = filters.TKinter;
+			dialogString.reserve(GetFilterPartSizeHint(filters, 8));
+
+			dialogString += "filetypes=(";
+			for(std::size_t i = 0; i < filters.Filters.size(); ++i)
+			{
+				const std::size_t start = dialogString.size();
+				dialogString += "('";
+				MD::Detail::AppendPythonEscaped(dialogString, filters.Filters[i].first);
+				dialogString += "',('";
+				if(AppendFilterPatterns(dialogString, filters.Patterns[i], "','", MaxFilterPartSize - 6, MD::Detail::AppendPythonEscaped) == 0)
+				{
+					dialogString.resize(start);
+					break;
+				}
+				dialogString += "',)),";
+			}
+
+			if(filters.AllFiles)
+				dialogString += "('All Files','*'))";
+			else
+				dialogString += ")";
+		});
+
+		return filters.TKinter;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetShellementaryMsgBoxCommand(const std::string& title,
-		                                                    const std::string& message,
-		                                                    const MD::Style style,
-		                                                    const MD::Buttons buttons)
+	/// <summary>
+	/// Append name='value', to a Python call in the given script, value is escaped for the string literal.
+	/// </summary>
+	void AppendPythonArgument(std::string& script, const std::string_view name, const std::string_view value)
 	{
-		return GetGenericMsgBoxCommandPart(title, message, style, buttons, "shellementary", GetGenericMsgBoxIconCommandPart(style));
+		script += name;
+		script += "='";
+		MD::Detail::AppendPythonEscaped(script, value);
+		script += "',";
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] std::string GetQarmaMsgBoxCommand(const std::string& title,
-		                                            const std::string& message,
-		                                            const MD::Style style,
-		                                            const MD::Buttons buttons)
+	/// <summary>
+	/// Append initialdir and initialfile arguments for the given default path to a Python call in the given script.
+	/// </summary>
+	void AppendPythonPathArguments(std::string& script, const std::string_view defaultPathAndFile, const bool withFile)
 	{
+		if(defaultPathAndFile.empty())
+			return;
 
-		std::string dialogString = "qarma";
-		if(XPropPresent())
-			dialogString += XPropCmd;
+		const std::string_view dir = GetPathViewWithoutFinalSlash(defaultPathAndFile);
+		if(!dir.empty())
+			AppendPythonArgument(script, "initialdir", dir);
 
-		return GetGenericMsgBoxCommandPart(title, message, style, buttons, dialogString, GetGenericMsgBoxIconCommandPart(style));
+		const std::string_view file = GetLastNameView(defaultPathAndFile);
+		if(withFile && !file.empty())
+			AppendPythonArgument(script, "initialfile", file);
 	}
 
-	#endif
-
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] CPP20Constexpr bool FilenameValid(const std::string_view filenameWithoutPath)
+	/// <summary>
+	/// Build the command line running the given Python script with tkinter.
+	/// </summary>
+	[[nodiscard]] Command GetTKinter3Command(std::string script)
 	{
-		if (filenameWithoutPath.empty())
-			return false;
-
-		return std::all_of(filenameWithoutPath.cbegin(), filenameWithoutPath.cend(), [](const char c)
-		{
-			return c != '\\' && c != '/' && c != ':' && c != '*' && c != '?' &&
-				   c != '\"' && c != '<' && c != '>' && c != '|';
-		});
+		//Not built from an initializer list, which would copy the script
+		Command command{};
+		command.reserve(4);
+		command.push_back(GetBackendInfo().Python3);
+		command.push_back("-S");
+		command.push_back("-c");
+		command.push_back(std::move(script));
+
+		return command;
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] CPP20Constexpr bool QuoteDetected(const std::string_view str)
+	[[nodiscard]] Command GetTKinter3SaveFileCommand(const std::string& title,
+		                                             const std::string& defaultPathAndFile,
+		                                             const MD::FilterSet::Data& filters)
 	{
-		if (str.empty())
-			return false;
+		std::string dialogString = "import sys,tkinter;from tkinter import filedialog;root=tkinter.Tk();root.withdraw();";
 
-		if (str.find_first_of('\'') != std::string_view::npos || str.find_first_of('\"') != std::string_view::npos)
-			return true;
+		dialogString += "res=filedialog.asksaveasfilename(";
 
-		return false;
+		if(!title.empty())
+			AppendPythonArgument(dialogString, "title", title);
+
+		AppendPythonPathArguments(dialogString, defaultPathAndFile, true);
+
+		dialogString += GetTKinter3FileCommandFilterPart(filters);
+
+		dialogString += ");\nif isinstance(res, str) and res:\n\tsys.stdout.write(res+'\\0')\n";
+
+		return GetTKinter3Command(std::move(dialogString));
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool DirExists(const std::string& dirPath)
+	[[nodiscard]] Command GetTKinter3OpenFileCommand(const std::string& title,
+		                                             const std::string& defaultPathAndFile,
+		                                             const MD::FilterSet::Data& filters,
+		                                             const bool allowMultipleSelects)
 	{
-		std::error_code ec{};
+		std::string dialogString = "import sys,tkinter;from tkinter import filedialog;root=tkinter.Tk();root.withdraw();";
 
-		const bool isDir = std::filesystem::is_directory(dirPath, ec);
-		if(ec != std::error_code{})
-			return false;
+		dialogString += "lFiles=filedialog.askopenfilename(";
 
-		const bool dirExists = std::filesystem::exists(dirPath, ec);
-		if(ec != std::error_code{})
-			return false;
+		if(allowMultipleSelects)
+			dialogString += "multiple=1,";
+
+		if(!title.empty())
+			AppendPythonArgument(dialogString, "title", title);
+
+		AppendPythonPathArguments(dialogString, defaultPathAndFile, true);
 
-		return isDir && dirExists;
+		dialogString += GetTKinter3FileCommandFilterPart(filters);
+
+		dialogString += ");\nif not isinstance(lFiles, tuple):\n\tlFiles=(lFiles,) if lFiles else ()\n";
+		dialogString += "sys.stdout.write(''.join(str(lFile)+'\\0' for lFile in lFiles))\n";
+
+		return GetTKinter3Command(std::move(dialogString));
 	}
 
 	//-------------------------------------------------------------------------------------------------------------------//
 
-	[[nodiscard]] bool FileExists(const std::string& filePathAndName)
+	/// <summary>
+	/// Build a file selection command for Zenity and its clones (MateDialog, Shellementary, Qarma).
+	/// </summary>
+	[[nodiscard]] Command GetGenericFileCommand(const std::string& executable,
+		                                        const bool attach,
+		                                        const CommandAction commandAction,
+		                                        const std::string& title,
+		                                        const std::string& defaultPathAndFile,
+		                                        const MD::FilterSet::Data& filters)
 	{
-		std::error_code ec{};
+		Command command{};
+		command.reserve(6 + commandAction.size() + filters.Filters.size());
+		command.push_back(executable);
 
-		const bool isFile = std::filesystem::is_regular_file(filePathAndName, ec);
-		if(ec != std::error_code{})
-			return false;
+		if(attach)
+			AppendAttachArgument(command);
 
-		const bool fileExists = std::filesystem::exists(filePathAndName, ec);
-		if(ec != std::error_code{})
-			return false;
+		command.push_back("--file-selection");
+		command.insert(command.end(), commandAction.begin(), commandAction.end());
+
+		if(!title.empty())
+			command.push_back("--title=" + title);
+		if(!defaultPathAndFile.empty())
+			command.push_back("--filename=" + defaultPathAndFile);
+		AppendGenericFileCommandFilterPart(command, filters);
 
-		return isFile && fileExists;
+		return command;
 	}
-}
 
-//-------------------------------------------------------------------------------------------------------------------//
+	//-------------------------------------------------------------------------------------------------------------------//
 
-std::string MD::SaveFile(const std::string& title,
-                          const std::string& defaultPathAndFile,
-                          const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-                          const bool allFiles)
-{
-	if (QuoteDetected(title))
-		return SaveFile("INVALID TITLE WITH QUOTES", defaultPathAndFile, filterPatterns, allFiles);
-	if (QuoteDetected(defaultPathAndFile))
-		return SaveFile(title, "INVALID DEFAULT_PATH WITH QUOTES", filterPatterns, allFiles);
-	for(const auto& filterPattern : filterPatterns)
+	[[nodiscard]] Command GetGenericSaveFileCommand(const std::string& executable,
+		                                            const bool attach,
+		                                            const std::string& title,
+		                                            const std::string& defaultPathAndFile,
+		                                            const MD::FilterSet::Data& filters)
 	{
-		if (QuoteDetected(filterPattern.first) || QuoteDetected(filterPattern.second))
-			return SaveFile("INVALID FILTER_PATTERN WITH QUOTES", defaultPathAndFile, {}, allFiles);
+		return GetGenericFileCommand(executable, attach, {"--save", "--confirm-overwrite"}, title, defaultPathAndFile, filters);
 	}
 
-	std::string path{};
-#ifdef _WIN32
-	path = SaveFileWinGUI(title, defaultPathAndFile, filterPatterns, allFiles);
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetGenericOpenFileCommand(const std::string& executable,
+		                                            const bool attach,
+		                                            const std::string& title,
+		                                            const std::string& defaultPathAndFile,
+		                                            const MD::FilterSet::Data& filters,
+		                                            const bool allowMultipleSelects)
+	{
+		if(allowMultipleSelects)
+			return GetGenericFileCommand(executable, attach, {"--multiple", "--separator=\n"}, title, defaultPathAndFile, filters);
+
+		return GetGenericFileCommand(executable, attach, {}, title, defaultPathAndFile, filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetGenericSelectFolderCommand(const std::string& executable,
+		                                                const bool attach,
+		                                                const std::string& title,
+		                                                const std::string& defaultPath)
+	{
+		return GetGenericFileCommand(executable, attach, {"--directory"}, title, defaultPath, GetNoFilters());
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool ZenityAttach()
+	{
+		return Zenity3Present() >= 4 && CanAttachToWindow();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetZenitySaveFileCommand(const std::string& title,
+		                                           const std::string& defaultPathAndFile,
+		                                           const MD::FilterSet::Data& filters)
+	{
+		return GetGenericSaveFileCommand(GetExecutables().Zenity, ZenityAttach(), title, defaultPathAndFile, filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetZenityOpenFileCommand(const std::string& title,
+		                                           const std::string& defaultPathAndFile,
+		                                           const MD::FilterSet::Data& filters,
+		                                           const bool allowMultipleSelects)
+	{
+		return GetGenericOpenFileCommand(GetExecutables().Zenity, ZenityAttach(), title, defaultPathAndFile, filters, allowMultipleSelects);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetMateDialogSaveFileCommand(const std::string& title,
+		                                               const std::string& defaultPathAndFile,
+		                                               const MD::FilterSet::Data& filters)
+	{
+		return GetGenericSaveFileCommand(GetExecutables().MateDialog, false, title, defaultPathAndFile, filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetMateDialogOpenFileCommand(const std::string& title,
+		                                               const std::string& defaultPathAndFile,
+		                                               const MD::FilterSet::Data& filters,
+		                                               const bool allowMultipleSelects)
+	{
+		return GetGenericOpenFileCommand(GetExecutables().MateDialog, false, title, defaultPathAndFile, filters, allowMultipleSelects);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetShellementarySaveFileCommand(const std::string& title,
+		                                                  const std::string& defaultPathAndFile,
+		                                                  const MD::FilterSet::Data& filters)
+	{
+		return GetGenericSaveFileCommand(GetExecutables().Shellementary, false, title, defaultPathAndFile, filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetShellementaryOpenFileCommand(const std::string& title,
+		                                                  const std::string& defaultPathAndFile,
+		                                                  const MD::FilterSet::Data& filters,
+		                                                  const bool allowMultipleSelects)
+	{
+		return GetGenericOpenFileCommand(GetExecutables().Shellementary, false, title, defaultPathAndFile, filters, allowMultipleSelects);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetQarmaSaveFileCommand(const std::string& title,
+		                                          const std::string& defaultPathAndFile,
+		                                          const MD::FilterSet::Data& filters)
+	{
+		return GetGenericSaveFileCommand(GetExecutables().Qarma, CanAttachToWindow(), title, defaultPathAndFile, filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetQarmaOpenFileCommand(const std::string& title,
+		                                          const std::string& defaultPathAndFile,
+		                                          const MD::FilterSet::Data& filters,
+		                                          const bool allowMultipleSelects)
+	{
+		return GetGenericOpenFileCommand(GetExecutables().Qarma, CanAttachToWindow(), title, defaultPathAndFile, filters, allowMultipleSelects);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetZenitySelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		return GetGenericSelectFolderCommand(GetExecutables().Zenity, ZenityAttach(), title, defaultPath);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetMateDialogSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		return GetGenericSelectFolderCommand(GetExecutables().MateDialog, false, title, defaultPath);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetShellementarySelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		return GetGenericSelectFolderCommand(GetExecutables().Shellementary, false, title, defaultPath);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetQarmaSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		return GetGenericSelectFolderCommand(GetExecutables().Qarma, CanAttachToWindow(), title, defaultPath);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetKDialogSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		return GetKDialogBaseFileCommand(title, defaultPath, GetNoFilters(), {"--getexistingdirectory"});
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetYadSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		return GetYadBaseFileCommand(title, defaultPath, GetNoFilters(), {"--file", "--directory"});
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetTKinter3SelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		std::string dialogString = "import sys,tkinter;from tkinter import filedialog;root=tkinter.Tk();root.withdraw();";
+		dialogString += "res=filedialog.askdirectory(";
+		if(!title.empty())
+			AppendPythonArgument(dialogString, "title", title);
+		if(!defaultPath.empty())
+			AppendPythonArgument(dialogString, "initialdir", defaultPath);
+		dialogString += ");\nif isinstance(res, str) and res:\n\tsys.stdout.write(res+'\\0')\n";
+
+		return GetTKinter3Command(std::move(dialogString));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetKDialogMsgBoxCommand(const std::string& title,
+		                                          const std::string& message,
+		                                          const MD::Style style,
+		                                          const MD::Buttons buttons)
+	{
+		Command command{GetExecutables().KDialog};
+		if (KDialogPresent() == 2 && CanAttachToWindow())
+			AppendAttachArgument(command);
+
+		if (buttons == MD::Buttons::OKCancel || buttons == MD::Buttons::YesNo)
+		{
+			if (style == MD::Style::Warning || style == MD::Style::Error)
+				command.push_back("--warningyesno");
+			else
+				command.push_back("--yesno");
+		}
+		else if (style == MD::Style::Error)
+			command.push_back("--error");
+		else if (style == MD::Style::Warning)
+			command.push_back("--sorry");
+		else
+			command.push_back("--msgbox");
+
+		command.push_back(message);
+
+		if (buttons == MD::Buttons::OKCancel)
+			command.insert(command.end(), {"--yes-label", "OK", "--no-label", "Cancel"});
+		if (buttons == MD::Buttons::Quit)
+			command.insert(command.end(), {"--ok-label", "Quit"});
+		if (!title.empty())
+		{
+			command.push_back("--title");
+			command.push_back(title);
+		}
+
+		return command;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetYadMsgBoxCommand(const std::string& title,
+		                                      const std::string& message,
+		                                      const MD::Style style,
+		                                      const MD::Buttons buttons)
+	{
+		Command command{GetExecutables().Yad};
+
+		if(buttons == MD::Buttons::OK)
+			command.push_back("--button=OK:1");
+		else if(buttons == MD::Buttons::OKCancel)
+			command.insert(command.end(), {"--button=OK:1", "--button=Cancel:0"});
+		else if(buttons == MD::Buttons::YesNo)
+			command.insert(command.end(), {"--button=Yes:1", "--button=No:0"});
+		else if(style == MD::Style::Error)
+			command.push_back("--error");
+		else if(style == MD::Style::Warning)
+			command.push_back("--warning");
+		else if(style == MD::Style::Question)
+			command.push_back("--question");
+		else
+			command.push_back("--info");
+
+		if(!title.empty())
+			command.push_back("--title=" + title);
+		if(!message.empty())
+			MD::Detail::AppendMarkupEscaped(command.emplace_back("--text="), message);
+
+		if(style == MD::Style::Error)
+			command.push_back("--image=dialog-error");
+		else if(style == MD::Style::Warning)
+			command.push_back("--image=dialog-warning");
+		else if(style == MD::Style::Question)
+			command.push_back("--image=dialog-question");
+		else
+			command.push_back("--image=dialog-information");
+
+		return command;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetTKinter3MsgBoxCommand(const std::string& title,
+		                                           const std::string& message,
+		                                           const MD::Style style,
+		                                           const MD::Buttons buttons)
+	{
+		std::string dialogString = "import tkinter;from tkinter import messagebox;root=tkinter.Tk();root.withdraw();";
+		dialogString += "res=messagebox.";
+
+		if(buttons == MD::Buttons::OKCancel)
+			dialogString += "askokcancel(";
+		else if(buttons == MD::Buttons::YesNo)
+			dialogString += "askyesno(";
+		else
+			dialogString += "showinfo(";
+
+		dialogString += "icon='";
+
+		if(style == MD::Style::Error)
+			dialogString += "error";
+		else if(style == MD::Style::Question)
+			dialogString += "question";
+		else if(style == MD::Style::Warning)
+			dialogString += "warning";
+		else
+			dialogString += "info";
+
+		dialogString += "',";
+
+		if(!title.empty())
+			AppendPythonArgument(dialogString, "title", title);
+		if(!message.empty())
+			AppendPythonArgument(dialogString, "message", message);
+
+		dialogString += ");\nif res is False :\n\tprint (0)\nelse :\n\tprint (1)\n";
+
+		return GetTKinter3Command(std::move(dialogString));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Build a message box command for Zenity and its clones (MateDialog, Shellementary, Qarma).<br>
+	/// The GTK based ones parse the text as Pango markup, Qarma shows it as Qt rich text only if it looks like HTML.
+	/// </summary>
+	[[nodiscard]] Command GetGenericMsgBoxCommand(const std::string& executable,
+		                                          const bool attach,
+		                                          const bool useIcon,
+		                                          const bool markup,
+		                                          const std::string& title,
+		                                          const std::string& message,
+		                                          const MD::Style style,
+		                                          const MD::Buttons buttons)
+	{
+		Command command{executable};
+
+		if(attach)
+			AppendAttachArgument(command);
+
+		if(buttons == MD::Buttons::OKCancel)
+			command.insert(command.end(), {"--question", "--ok-label=OK", "--cancel-label=Cancel"});
+		else if(buttons == MD::Buttons::YesNo)
+			command.push_back("--question");
+		else if(style == MD::Style::Error)
+			command.push_back("--error");
+		else if(style == MD::Style::Warning)
+			command.push_back("--warning");
+		else
+			command.push_back("--info");
+
+		if(buttons == MD::Buttons::Quit)
+			command.push_back("--ok-label=Quit");
+
+		if(!title.empty())
+			command.push_back("--title=" + title);
+		if(!message.empty())
+		{
+			std::string& text = command.emplace_back("--text=");
+			if(markup)
+				MD::Detail::AppendMarkupEscaped(text, message);
+			else
+				text += message;
+		}
+
+		if(useIcon)
+		{
+			if(style == MD::Style::Question)
+				command.push_back("--icon-name=dialog-question");
+			else if(style == MD::Style::Error)
+				command.push_back("--icon-name=dialog-error");
+			else if(style == MD::Style::Warning)
+				command.push_back("--icon-name=dialog-warning");
+			else
+				command.push_back("--icon-name=dialog-information");
+		}
+
+		return command;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetZenityMsgBoxCommand(const std::string& title,
+		                                         const std::string& message,
+		                                         const MD::Style style,
+		                                         const MD::Buttons buttons)
+	{
+		return GetGenericMsgBoxCommand(GetExecutables().Zenity, ZenityAttach(), true, true, title, message, style, buttons);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetMateDialogMsgBoxCommand(const std::string& title,
+		                                             const std::string& message,
+		                                             const MD::Style style,
+		                                             const MD::Buttons buttons)
+	{
+		return GetGenericMsgBoxCommand(GetExecutables().MateDialog, false, false, true, title, message, style, buttons);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetShellementaryMsgBoxCommand(const std::string& title,
+		                                                const std::string& message,
+		                                                const MD::Style style,
+		                                                const MD::Buttons buttons)
+	{
+		return GetGenericMsgBoxCommand(GetExecutables().Shellementary, false, true, true, title, message, style, buttons);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetQarmaMsgBoxCommand(const std::string& title,
+		                                        const std::string& message,
+		                                        const MD::Style style,
+		                                        const MD::Buttons buttons)
+	{
+		return GetGenericMsgBoxCommand(GetExecutables().Qarma, CanAttachToWindow(), true, false, title, message, style, buttons);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Interpret the answer of a message box which reports it through its exit status (0 = accepted).
+	/// </summary>
+	/// <returns>1 if accepted, 0 if declined.</returns>
+	[[nodiscard]] int32_t GetExitStatusMsgBoxAnswer(const ProcessResult& result)
+	{
+		return result.ExitStatus == 0 ? 1 : 0;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Interpret the answer of a Yad message box, its buttons return their configured id as exit status.
+	/// </summary>
+	/// <returns>1 if accepted, 0 if declined, -1 if the dialog was closed otherwise.</returns>
+	[[nodiscard]] int32_t GetYadMsgBoxAnswer(const ProcessResult& result)
+	{
+		if(result.ExitStatus == 1)
+			return 1;
+		if(result.ExitStatus == 0)
+			return 0;
+
+		return -1;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Interpret the answer of a message box which prints "1" or "0".
+	/// </summary>
+	/// <returns>1 if accepted, 0 if declined, -1 on unexpected output.</returns>
+	[[nodiscard]] int32_t GetOutputMsgBoxAnswer(const ProcessResult& result)
+	{
+		std::string_view output = result.Output.View();
+		if(!output.empty() && output.back() == '\n')
+			output.remove_suffix(1);
+
+		if(output == "1")
+			return 1;
+		if(output == "0")
+			return 0;
+
+		return -1;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Fields of the command of the in-process backends (portal and GTK).<br>
+	/// The command only describes the file chooser, it is shown in-process instead of being run.
+	/// Filters follow the fixed fields as pairs of name and ';' separated patterns.
+	/// </summary>
+	enum class FileChooserField : std::size_t
+	{
+		Method,
+		Title,
+		Folder,
+		Name,
+		Multiple,
+		Directory,
+		//Parent window in the format of the portal (e.g. "x11:3a00007"), empty if unknown
+		ParentWindow,
+		Filters
+	};
+
+	[[nodiscard]] const std::string& GetFileChooserField(const Command& command, const FileChooserField field)
+	{
+		return command[static_cast<std::size_t>(field)];
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetFileChooserCommand(std::string method,
+	                                           const std::string& title,
+	                                           std::string folder,
+	                                           std::string name,
+	                                           const bool multiple,
+	                                           const bool directory,
+	                                           const MD::FilterSet::Data& filters)
+	{
+		Command command{std::move(method), title, std::move(folder), std::move(name), multiple ? "1" : "", directory ? "1" : "", ""};
+
+		//Only an explicit parent is passed, the portal already places dialogs sensibly otherwise
+		if(const uint64_t parentWindow = ParentWindow; parentWindow != 0)
+		{
+			std::array<char, 20> buffer{};
+			const char* const end = std::to_chars(buffer.data(), buffer.data() + buffer.size(), parentWindow, 16).ptr;
+			command[static_cast<std::size_t>(FileChooserField::ParentWindow)] = "x11:" + std::string(buffer.data(), static_cast<std::size_t>(end - buffer.data()));
+		}
+
+		command.reserve(command.size() + (filters.Filters.size() + 1) * 2);
+		for(const auto& [filterName, extensions] : filters.Filters)
+		{
+			command.push_back(filterName);
+			command.push_back(extensions);
+		}
+
+		if(filters.AllFiles)
+		{
+			command.push_back("All Files");
+			command.push_back("*");
+		}
+
+		return command;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetFileChooserSaveFileCommand(const std::string& title,
+		                                           const std::string& defaultPathAndFile,
+		                                           const MD::FilterSet::Data& filters)
+	{
+		return GetFileChooserCommand("SaveFile", title, GetPathWithoutFinalSlash(defaultPathAndFile), GetLastName(defaultPathAndFile),
+		                            false, false, filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetFileChooserOpenFileCommand(const std::string& title,
+		                                           const std::string& defaultPathAndFile,
+		                                           const MD::FilterSet::Data& filters,
+		                                           const bool allowMultipleSelects)
+	{
+		//The portal has no preselected file for opening, only the folder is used
+		return GetFileChooserCommand("OpenFile", title, GetPathWithoutFinalSlash(defaultPathAndFile), "",
+		                            allowMultipleSelects, false, filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] Command GetFileChooserSelectFolderCommand(const std::string& title, const std::string& defaultPath)
+	{
+		return GetFileChooserCommand("OpenFile", title, defaultPath, "", false, true, GetNoFilters());
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	using SaveFileCommandBuilder = Command(*)(const std::string& title,
+	                                          const std::string& defaultPathAndFile,
+	                                          const MD::FilterSet::Data& filters);
+	using OpenFileCommandBuilder = Command(*)(const std::string& title,
+	                                          const std::string& defaultPathAndFile,
+	                                          const MD::FilterSet::Data& filters,
+	                                          bool allowMultipleSelects);
+	using SelectFolderCommandBuilder = Command(*)(const std::string& title, const std::string& defaultPath);
+	using MsgBoxCommandBuilder = Command(*)(const std::string& title,
+	                                        const std::string& message,
+	                                        MD::Style style,
+	                                        MD::Buttons buttons);
+	using MsgBoxAnswerParser = int32_t(*)(const ProcessResult& result);
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Dialog types a backend is able to show.
+	/// </summary>
+	enum class BackendCapability : uint32_t
+	{
+		SaveFile = 1u << 0u,
+		OpenFile = 1u << 1u,
+		SelectFolder = 1u << 2u,
+		MsgBox = 1u << 3u,
+
+		All = SaveFile | OpenFile | SelectFolder | MsgBox
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// How the command of a dialog gets run.
+	/// </summary>
+	enum class DialogRunner : uint8_t
+	{
+		//Start the command as a process
+		Process,
+		//Send the script (last argument) to the persistent tkinter helper if enabled, see MD::SetTKinterHelperEnabled()
+		TKinterHelper,
+		//Call the xdg-desktop-portal in-process, the command describes the request
+		Portal,
+		//Show a GTK file chooser in-process, the command describes the request
+		GTK
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Entry of the backend registry.
+	/// </summary>
+	struct Backend
+	{
+		std::string_view Name;
+		uint32_t Capabilities;
+		bool(*Present)(const BackendInfo& info);
+
+		SaveFileCommandBuilder SaveFile;
+		OpenFileCommandBuilder OpenFile;
+		SelectFolderCommandBuilder SelectFolder;
+		MsgBoxCommandBuilder MsgBox;
+		MsgBoxAnswerParser MsgBoxAnswer;
+
+		//Terminates every path in the output of the file dialogs.
+		//'\n' can't represent paths containing newlines, '\0' is used where the backend allows it as it can't appear in paths
+		char PathSeparator;
+		DialogRunner Runner;
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// All Linux backends in order of preference.
+	/// </summary>
+	constexpr std::array<Backend, 8> Backends
+	{
+		{
+			{
+				"portal", static_cast<uint32_t>(BackendCapability::SaveFile) | static_cast<uint32_t>(BackendCapability::OpenFile) | static_cast<uint32_t>(BackendCapability::SelectFolder),
+				//Directory mode of OpenFile was added in version 3
+				[](const BackendInfo& info){ return info.Portal >= 3; },
+				GetFileChooserSaveFileCommand, GetFileChooserOpenFileCommand, GetFileChooserSelectFolderCommand, nullptr, nullptr,
+				'\0', DialogRunner::Portal
+			},
+			{
+				"kdialog", static_cast<uint32_t>(BackendCapability::All), [](const BackendInfo& info){ return info.KDialog != 0; },
+				GetKDialogSaveFileCommand, GetKDialogOpenFileCommand, GetKDialogSelectFolderCommand, GetKDialogMsgBoxCommand, GetExitStatusMsgBoxAnswer,
+				'\n', DialogRunner::Process
+			},
+			{
+				"zenity", static_cast<uint32_t>(BackendCapability::All), [](const BackendInfo& info){ return info.Zenity; },
+				GetZenitySaveFileCommand, GetZenityOpenFileCommand, GetZenitySelectFolderCommand, GetZenityMsgBoxCommand, GetExitStatusMsgBoxAnswer,
+				'\n', DialogRunner::Process
+			},
+			{
+				"matedialog", static_cast<uint32_t>(BackendCapability::All), [](const BackendInfo& info){ return info.MateDialog; },
+				GetMateDialogSaveFileCommand, GetMateDialogOpenFileCommand, GetMateDialogSelectFolderCommand, GetMateDialogMsgBoxCommand, GetExitStatusMsgBoxAnswer,
+				'\n', DialogRunner::Process
+			},
+			{
+				"shellementary", static_cast<uint32_t>(BackendCapability::All), [](const BackendInfo& info){ return info.Shellementary; },
+				GetShellementarySaveFileCommand, GetShellementaryOpenFileCommand, GetShellementarySelectFolderCommand, GetShellementaryMsgBoxCommand, GetExitStatusMsgBoxAnswer,
+				'\n', DialogRunner::Process
+			},
+			{
+				"qarma", static_cast<uint32_t>(BackendCapability::All), [](const BackendInfo& info){ return info.Qarma; },
+				GetQarmaSaveFileCommand, GetQarmaOpenFileCommand, GetQarmaSelectFolderCommand, GetQarmaMsgBoxCommand, GetExitStatusMsgBoxAnswer,
+				'\n', DialogRunner::Process
+			},
+			{
+				"yad", static_cast<uint32_t>(BackendCapability::All), [](const BackendInfo& info){ return info.Yad; },
+				GetYadSaveFileCommand, GetYadOpenFileCommand, GetYadSelectFolderCommand, GetYadMsgBoxCommand, GetYadMsgBoxAnswer,
+				'\n', DialogRunner::Process
+			},
+			{
+				"tkinter3", static_cast<uint32_t>(BackendCapability::All), [](const BackendInfo& info){ return info.TKinter3; },
+				GetTKinter3SaveFileCommand, GetTKinter3OpenFileCommand, GetTKinter3SelectFolderCommand, GetTKinter3MsgBoxCommand, GetOutputMsgBoxAnswer,
+				'\0', DialogRunner::TKinterHelper
+			}
+		}
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Opt-in backend showing GTK file choosers in-process, see MD::SetGTKBackendEnabled().
+	/// </summary>
+	constexpr Backend GTKBackend
+	{
+		"gtk", static_cast<uint32_t>(BackendCapability::SaveFile) | static_cast<uint32_t>(BackendCapability::OpenFile) | static_cast<uint32_t>(BackendCapability::SelectFolder),
+		[](const BackendInfo&){ return true; },
+		GetFileChooserSaveFileCommand, GetFileChooserOpenFileCommand, GetFileChooserSelectFolderCommand, nullptr, nullptr,
+		'\0', DialogRunner::GTK
+	};
+
+	[[nodiscard]] bool UseGTKBackend();
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Retrieve the backend to use for the given dialog type.<br>
+	/// The registry is resolved once, afterwards this is a plain table lookup.
+	/// </summary>
+	/// <param name="capability">Dialog type to show.</param>
+	/// <returns>Backend to use or nullptr if no backend is available.</returns>
+	[[nodiscard]] const Backend* GetBackend(const BackendCapability capability)
+	{
+		static const std::array<const Backend*, 4> activeBackends = []()
+		{
+			const BackendInfo& info = GetBackendInfo();
+
+			std::array<const Backend*, 4> result{};
+			for(std::size_t i = 0; i < result.size(); ++i)
+			{
+				const uint32_t requiredCapability = 1u << i;
+				for(const Backend& backend : Backends)
+				{
+					if((backend.Capabilities & requiredCapability) && backend.Present(info))
+					{
+						result[i] = &backend;
+						break;
+					}
+				}
+			}
+
+			return result;
+		}();
+
+		//Opt-in backends take precedence over the registry while enabled
+		if(capability != BackendCapability::MsgBox && UseGTKBackend())
+			return &GTKBackend;
+
+		switch(capability)
+		{
+		case BackendCapability::SaveFile:
+			return activeBackends[0];
+
+		case BackendCapability::OpenFile:
+			return activeBackends[1];
+
+		case BackendCapability::SelectFolder:
+			return activeBackends[2];
+
+		case BackendCapability::MsgBox:
+			return activeBackends[3];
+
+		default:
+			return nullptr;
+		}
+	}
+
+	#endif
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	//Below this length setting up the vectorised scan costs more than it saves, most file names are shorter
+	constexpr std::size_t MinVectorisedFilenameSize = 80;
+
+	[[nodiscard]] bool FilenameValid(const std::string_view filenameWithoutPath)
+	{
+		if (filenameWithoutPath.empty())
+			return false;
+
+		if (filenameWithoutPath.size() < MinVectorisedFilenameSize)
+		{
+			return std::all_of(filenameWithoutPath.cbegin(), filenameWithoutPath.cend(), [](const char c)
+			{
+				return c != '\\' && c != '/' && c != ':' && c != '*' && c != '?' &&
+				       c != '\"' && c != '<' && c != '>' && c != '|';
+			});
+		}
+
+		return MD::Detail::FindFirstOf(filenameWithoutPath, "\\/:*?\"<>|") == std::string_view::npos;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	enum class PathType : uint8_t
+	{
+		Missing,
+		File,
+		Directory,
+		Other
+	};
+
+	/// <summary>
+	/// Retrieve the type of the given path with a single stat call.
+	/// </summary>
+	/// <param name="path">Null terminated path to check, symlinks are followed.</param>
+	/// <returns>Type of the path, PathType::Missing if it doesn't exist or can't be accessed.</returns>
+	[[nodiscard]] PathType GetPathType(const char* const path)
+	{
+#ifdef _WIN32
+		std::error_code ec{};
+		const std::filesystem::file_status status = std::filesystem::status(path, ec);
+		if(ec != std::error_code{})
+			return PathType::Missing;
+
+		switch(status.type())
+		{
+		case std::filesystem::file_type::regular:
+			return PathType::File;
+
+		case std::filesystem::file_type::directory:
+			return PathType::Directory;
+
+		case std::filesystem::file_type::not_found:
+		case std::filesystem::file_type::none:
+			return PathType::Missing;
+
+		default:
+			return PathType::Other;
+		}
+#else
+		mode_t mode = 0;
+#ifdef STATX_TYPE
+		//Only the file type is requested, so filesystems can skip gathering everything else
+		struct statx statxBuffer{};
+		if(statx(AT_FDCWD, path, 0, STATX_TYPE, &statxBuffer) == 0)
+			mode = statxBuffer.stx_mode;
+		else if(errno == ENOSYS)
+#endif
+		{
+			struct stat statBuffer{};
+			if(stat(path, &statBuffer) != 0)
+				return PathType::Missing;
+			mode = statBuffer.st_mode;
+		}
+
+		if(mode == 0)
+			return PathType::Missing;
+		if(S_ISREG(mode))
+			return PathType::File;
+		if(S_ISDIR(mode))
+			return PathType::Directory;
+
+		return PathType::Other;
+#endif
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	//Selections smaller than this are checked on the calling thread, unless a timeout is set
+	constexpr std::size_t PathsPerValidationWorker = 64;
+	//Upper bound for the threads of the validation pool, so also for the threads stuck on hung mounts
+	constexpr std::size_t MaxValidationWorkers = 4;
+
+	std::atomic<int64_t> PathValidationTimeoutMilliseconds{0};
+
+	[[nodiscard]] const char* GetPathCString(const std::string& path)
+	{
+		return path.c_str();
+	}
+
+	//Views handed to the validation always point into a buffer with a null terminator after each path
+	[[nodiscard]] const char* GetPathCString(const std::string_view path)
+	{
+		return path.data();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Persistent threads checking paths for RetainPathsOfType().<br>
+	/// Threads are started on demand up to MaxValidationWorkers and then reused,
+	/// a thread stuck on a hung mount only takes one of them out until the mount recovers.
+	/// </summary>
+	class PathValidationPool
+	{
+	public:
+		/// <summary>
+		/// Queue a part of a validation.
+		/// </summary>
+		/// <param name="owner">Validation the task belongs to, see Cancel().</param>
+		/// <param name="task">Task to run on a pool thread.</param>
+		/// <returns>Whether the task was queued, false if no thread could be started.</returns>
+		[[nodiscard]] bool Submit(const void* const owner, std::function<void()> task)
+		{
+			const std::lock_guard lock(m_mutex);
+
+			if(m_tasks.size() >= m_idleWorkers && m_workerCount < MaxValidationWorkers)
+			{
+				try
+				{
+					//The pool is never destroyed, so its threads don't have to be joined
+					std::thread(&PathValidationPool::Run, this).detach();
+					++m_workerCount;
+				}
+				catch(const std::system_error&)
+				{
+					if(m_workerCount == 0)
+						return false;
+				}
+			}
+
+			m_tasks.push_back({owner, std::move(task)});
+			m_condition.notify_one();
+
+			return true;
+		}
+
+		/// <summary>
+		/// Drop the queued tasks of a validation which timed out, tasks already running finish on their own.
+		/// </summary>
+		/// <param name="owner">Validation whose tasks to drop.</param>
+		void Cancel(const void* const owner)
+		{
+			const std::lock_guard lock(m_mutex);
+			m_tasks.erase(std::remove_if(m_tasks.begin(), m_tasks.end(), [owner](const Task& task){ return task.Owner == owner; }),
+			              m_tasks.end());
+		}
+
+	private:
+		struct Task
+		{
+			const void* Owner;
+			std::function<void()> Run;
+		};
+
+		void Run()
+		{
+			std::unique_lock lock(m_mutex);
+			while(true)
+			{
+				++m_idleWorkers;
+				m_condition.wait(lock, [this]{ return !m_tasks.empty(); });
+				--m_idleWorkers;
+
+				const std::function<void()> task = std::move(m_tasks.front().Run);
+				m_tasks.pop_front();
+
+				lock.unlock();
+				task();
+				lock.lock();
+			}
+		}
+
+		std::mutex m_mutex{};
+		std::condition_variable m_condition{};
+		std::deque<Task> m_tasks{};
+		std::size_t m_workerCount = 0;
+		std::size_t m_idleWorkers = 0;
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] PathValidationPool& GetPathValidationPool()
+	{
+		//Leaked on purpose, threads stuck on a hung mount at exit must neither block it nor touch a destroyed pool
+		static PathValidationPool* const pool = new PathValidationPool();
+		return *pool;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Paths being checked by the validation pool.<br>
+	/// Shared with the pool threads, so a check stuck on a hung mount can outlive the call which started it.
+	/// </summary>
+	template<typename P>
+	struct PathValidation
+	{
+		std::vector<P> Paths;
+		std::vector<PathType> Types;
+		//Keeps the storage of views alive
+		std::shared_ptr<const void> PathStorage;
+
+		std::mutex Mutex{};
+		std::condition_variable Finished{};
+		std::size_t PendingTasks = 0;
+	};
+
+	/// <summary>
+	/// Keep only the paths of the given type, preserving their order.<br>
+	/// Small selections are checked on the calling thread, large ones are split across the validation pool.
+	/// When a timeout is set via SetPathValidationTimeout() every check runs on the pool,
+	/// if it doesn't finish in time all paths are rejected.
+	/// </summary>
+	/// <param name="paths">Paths to check, std::string or null terminated std::string_view.</param>
+	/// <param name="type">Type the paths must have.</param>
+	/// <param name="pathStorage">Owner of the memory the paths point into, if they are views.</param>
+	/// <returns>Paths with the given type.</returns>
+	template<typename P>
+	[[nodiscard]] std::vector<P> RetainPathsOfType(std::vector<P> paths, const PathType type, std::shared_ptr<const void> pathStorage = nullptr)
+	{
+		const int64_t timeout = PathValidationTimeoutMilliseconds;
+		if(timeout <= 0 && paths.size() < PathsPerValidationWorker)
+		{
+			paths.erase(std::remove_if(paths.begin(), paths.end(), [type](const P& path){ return GetPathType(GetPathCString(path)) != type; }),
+			            paths.end());
+			return paths;
+		}
+
+		const std::shared_ptr<PathValidation<P>> validation = std::make_shared<PathValidation<P>>();
+		validation->Paths = std::move(paths);
+		validation->PathStorage = std::move(pathStorage);
+		validation->Types.resize(validation->Paths.size(), PathType::Missing);
+
+		const std::size_t pathCount = validation->Paths.size();
+		const std::size_t taskCount = std::clamp<std::size_t>((pathCount + PathsPerValidationWorker - 1) / PathsPerValidationWorker,
+		                                                      1, MaxValidationWorkers);
+		validation->PendingTasks = taskCount;
+
+		PathValidationPool& pool = GetPathValidationPool();
+		for(std::size_t index = 0; index < taskCount; ++index)
+		{
+			auto validate = [validation, begin = pathCount * index / taskCount, end = pathCount * (index + 1) / taskCount]()
+			{
+				for(std::size_t i = begin; i < end; ++i)
+					validation->Types[i] = GetPathType(GetPathCString(validation->Paths[i]));
+
+				const std::lock_guard lock(validation->Mutex);
+				if(--validation->PendingTasks == 0)
+					validation->Finished.notify_all();
+			};
+
+			if(!pool.Submit(validation.get(), validate))
+				validate();
+		}
+
+		{
+			std::unique_lock lock(validation->Mutex);
+			const auto finished = [&validation]{ return validation->PendingTasks == 0; };
+			if(timeout > 0)
+			{
+				if(!validation->Finished.wait_for(lock, std::chrono::milliseconds(timeout), finished))
+				{
+					lock.unlock();
+					pool.Cancel(validation.get());
+					return {};
+				}
+			}
+			else
+				validation->Finished.wait(lock, finished);
+		}
+
+		//All tasks are done, so the paths can be taken over
+		std::vector<P> result = std::move(validation->Paths);
+		std::size_t kept = 0;
+		for(std::size_t i = 0; i < pathCount; ++i)
+		{
+			if(validation->Types[i] != type)
+				continue;
+
+			if(kept != i)
+				result[kept] = std::move(result[i]);
+			++kept;
+		}
+		result.resize(kept);
+
+		return result;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool DirExists(const std::string& dirPath)
+	{
+		return !RetainPathsOfType(std::vector<std::string>{dirPath}, PathType::Directory).empty();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] std::string ValidateSaveFilePath(std::string path)
+	{
+		if (path.empty())
+			return "";
+		if (!FilenameValid(GetLastNameView(path)))
+			return "";
+		const std::string str = GetPathWithoutFinalSlash(path);
+		if (str.empty() || !DirExists(str))
+			return "";
+
+		return path;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	std::mutex CompletionExecutorMutex{};
+	MD::CompletionExecutor DialogCompletionExecutor{};
+
+#ifndef _WIN32
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Thread running the completion callbacks when no completion executor is set.<br>
+	/// Keeps callbacks off the process reactor thread, so a blocking callback can't stall the other asynchronous dialogs.
+	/// </summary>
+	struct CompletionQueue
+	{
+		std::mutex Mutex{};
+		std::condition_variable Condition{};
+		std::deque<std::function<void()>> Tasks{};
+		std::thread Thread{};
+		bool Stop = false;
+
+		CompletionQueue() = default;
+		CompletionQueue(const CompletionQueue&) = delete;
+		CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+		~CompletionQueue()
+		{
+			if(!Thread.joinable())
+				return;
+
+			{
+				const std::lock_guard lock(Mutex);
+				Stop = true;
+			}
+			Condition.notify_one();
+			Thread.join();
+		}
+
+		void Post(std::function<void()> task)
+		{
+			{
+				const std::lock_guard lock(Mutex);
+				if(!Thread.joinable())
+					Thread = std::thread(&CompletionQueue::Run, this);
+
+				Tasks.push_back(std::move(task));
+			}
+			Condition.notify_one();
+		}
+
+		void Run()
+		{
+			std::unique_lock lock(Mutex);
+			while(true)
+			{
+				Condition.wait(lock, [this]{ return Stop || !Tasks.empty(); });
+				//Callbacks still queued on shutdown get run before the thread exits
+				if(Tasks.empty())
+					break;
+
+				std::function<void()> task = std::move(Tasks.front());
+				Tasks.pop_front();
+
+				lock.unlock();
+				task();
+				lock.lock();
+			}
+		}
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] CompletionQueue& GetCompletionQueue()
+	{
+		static CompletionQueue queue{};
+		return queue;
+	}
+#endif
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Hand the result of an asynchronous dialog to the user callback.<br>
+	/// Goes through the completion executor if one is set.
+	/// Otherwise the callback is invoked directly on Windows, where every dialog has its own thread,
+	/// and on the completion queue thread on Linux.
+	/// </summary>
+	template<typename T>
+	void DeliverResult(const std::function<void(T)>& callback, T result)
+	{
+		if(!callback)
+			return;
+
+		MD::CompletionExecutor executor{};
+		{
+			const std::lock_guard lock(CompletionExecutorMutex);
+			executor = DialogCompletionExecutor;
+		}
+
+		if(executor)
+			executor([callback, result = std::move(result)]() mutable { callback(std::move(result)); });
+		else
+		{
+#ifdef _WIN32
+			callback(std::move(result));
+#else
+			GetCompletionQueue().Post([callback, result = std::move(result)]() mutable { callback(std::move(result)); });
+#endif
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Result of a dialog which got cancelled or timed out.
+	/// </summary>
+	template<typename T>
+	[[nodiscard]] T GetCancelledResult()
+	{
+		if constexpr(std::is_same_v<T, MD::Selection>)
+			return MD::Selection::None;
+		else
+			return T{};
+	}
+
+#ifdef _WIN32
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// The Windows dialogs are blocking API calls, so asynchronous dialogs each get their own worker thread.
+	/// </summary>
+	template<typename T, typename F>
+	[[nodiscard]] std::future<T> LaunchDialogFuture(F&& showDialog)
+	{
+		return std::async(std::launch::async, std::forward<F>(showDialog));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T, typename F>
+	void LaunchDialogCallback(std::function<void(T)> callback, F&& showDialog)
+	{
+		std::thread([callback = std::move(callback), showDialog = std::forward<F>(showDialog)]()
+		{
+			DeliverResult(callback, showDialog());
+		}).detach();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Dialog shown by the dialog objects (MD::SaveFileDialog, ...).<br>
+	/// The Windows dialogs have no command to prepare, so this only keeps the arguments.
+	/// </summary>
+	template<typename T>
+	class ReusableDialog
+	{
+	public:
+		explicit ReusableDialog(std::function<T()> show)
+			: m_show(std::move(show))
+		{
+		}
+
+		[[nodiscard]] T Show() const
+		{
+			return m_show();
+		}
+
+	private:
+		std::function<T()> m_show;
+	};
+#else
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	//Order in which dialogs waiting for MD::SetMaxConcurrentDialogs() get shown, higher first.
+	//File dialogs are opened by the user and go first, message boxes follow by severity.
+	constexpr int32_t FileDialogPriority = 4;
+
+	[[nodiscard]] constexpr int32_t GetMsgBoxPriority(const MD::Style style)
+	{
+		switch(style)
+		{
+		case MD::Style::Error:
+			return 3;
+		case MD::Style::Warning:
+			return 2;
+		case MD::Style::Question:
+			return 1;
+		default:
+			return 0;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// A dialog which still needs its backend process to run.
+	/// </summary>
+	template<typename T>
+	struct PendingDialog
+	{
+		Command DialogCommand;
+		//Turns the output of the backend process into the dialog result, gets std::nullopt if the process failed to start
+		std::function<T(std::optional<ProcessResult>)> Finish;
+		std::string_view BackendName;
+		DialogRunner Runner;
+		int32_t Priority = FileDialogPriority;
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	std::atomic<bool> TKinterHelperEnabled{false};
+
+	[[nodiscard]] DialogRunner GetDialogRunner(const Backend& backend)
+	{
+		if(backend.Runner == DialogRunner::TKinterHelper && !TKinterHelperEnabled)
+			return DialogRunner::Process;
+
+		return backend.Runner;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename F>
+	[[nodiscard]] Command BuildCommand(const Backend& backend, F&& build)
+	{
+		const TraceScope trace(MD::TracePhase::CommandBuild, backend.Name);
+		return build();
+	}
+
+	/// <summary>
+	/// Either the final dialog result (e.g. if no backend is available) or the dialog process to run.
+	/// </summary>
+	template<typename T>
+	using PreparedDialog = std::variant<T, PendingDialog<T>>;
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Retrieve the first path from the output of a file dialog.
+	/// </summary>
+	/// <param name="output">Output of the backend.</param>
+	/// <param name="separator">Separator terminating the paths in the output.</param>
+	/// <returns>First path or empty string.</returns>
+	[[nodiscard]] std::string GetFirstPath(const std::string_view output, const char separator)
+	{
+		return std::string(output.substr(0, output.find(separator)));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Retrieve text with invalid UTF-8 replaced by U+FFFD.<br>
+	/// Broken locales can hand over invalid sequences, which the backends reject or show garbled.
+	/// </summary>
+	/// <param name="text">Text to check.</param>
+	/// <param name="storage">Receives the sanitized copy, only used if text is invalid.</param>
+	/// <returns>text if it is valid, otherwise storage.</returns>
+	[[nodiscard]] const std::string& SanitizeUTF8(const std::string& text, std::string& storage)
+	{
+		if(MD::Detail::FindInvalidUTF8(text) == std::string_view::npos)
+			return text;
+
+		MD::Detail::AppendSanitizedUTF8(storage, text);
+		return storage;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Retrieve the default path to hand to a backend.<br>
+	/// Linux paths are bytes, replacing invalid UTF-8 like SanitizeUTF8() would point the dialog at a path which doesn't exist.
+	/// The backends take the path as text though, so such a path is dropped and the dialog opens at its usual location.
+	/// </summary>
+	/// <param name="path">Default path given by the caller.</param>
+	/// <returns>path if it is valid UTF-8, otherwise an empty string.</returns>
+	[[nodiscard]] const std::string& GetDefaultPathForBackend(const std::string& path)
+	{
+		static const std::string empty{};
+
+		return MD::Detail::FindInvalidUTF8(path) == std::string_view::npos ? path : empty;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	std::atomic<bool> PathNormalizationEnabled{false};
+
+	/// <summary>
+	/// Normalize a returned path to NFC if enabled, see MD::SetPathNormalizationEnabled().
+	/// </summary>
+	void NormalizePath(std::string& path)
+	{
+		if(PathNormalizationEnabled)
+			static_cast<void>(MD::Detail::NormalizeToNFC(path));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] PreparedDialog<std::string> PrepareSaveFile(const std::string& title,
+		                                                      const std::string& defaultPathAndFile,
+		                                                      const MD::FilterSet& filters)
+	{
+		const Backend* const backend = GetBackend(BackendCapability::SaveFile);
+		if(backend == nullptr)
+			return std::string{};
+
+		std::string titleStorage{};
+		const std::string& safeTitle = SanitizeUTF8(title, titleStorage);
+		const std::string& safePath = GetDefaultPathForBackend(defaultPathAndFile);
+
+		const char separator = backend->PathSeparator;
+
+		return PendingDialog<std::string>
+		{
+			BuildCommand(*backend, [&]{ return backend->SaveFile(safeTitle, safePath, filters.GetData()); }),
+			[separator, name = backend->Name](std::optional<ProcessResult> result)
+			{
+				if(!result)
+					return std::string{};
+
+				std::string path{};
+				{
+					const TraceScope trace(MD::TracePhase::Parse, name);
+					path = GetFirstPath(result->Output.View(), separator);
+				}
+
+				const TraceScope trace(MD::TracePhase::Validate, name);
+				path = ValidateSaveFilePath(std::move(path));
+				NormalizePath(path);
+
+				return path;
+			},
+			backend->Name,
+			GetDialogRunner(*backend)
+		};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Turn the output of an open file dialog into a path list, reusing the output buffer.<br>
+	/// Separators get replaced by null terminators in place and paths which aren't files are dropped.
+	/// </summary>
+	/// <param name="output">Output of the backend.</param>
+	/// <param name="separator">Separator terminating the paths in the output.</param>
+	/// <param name="allowMultipleSelects">Whether to keep more than the first path.</param>
+	/// <param name="backendName">Name of the backend for tracing.</param>
+	/// <returns>Validated paths.</returns>
+	[[nodiscard]] MD::PathList GetPathList(ProcessOutput output, const char separator, const bool allowMultipleSelects, const std::string_view backendName)
+	{
+		std::optional<TraceScope> trace{};
+		trace.emplace(MD::TracePhase::Parse, backendName);
+
+		//The last path may lack a separator, make sure there is room for its null terminator
+		if(output.Size == output.Capacity)
+		{
+			std::unique_ptr<char[]> data(new char[output.Size + 1]);
+			if(output.Size != 0)
+				std::memcpy(data.get(), output.Data.get(), output.Size);
+
+			output.Data = std::move(data);
+			output.Capacity = output.Size + 1;
+		}
+
+		std::vector<std::string_view> paths = MD::Detail::SplitPaths(output.View(), separator);
+		if(!allowMultipleSelects && paths.size() > 1)
+			paths.resize(1);
+
+		for(const std::string_view path : paths)
+			output.Data[static_cast<std::size_t>(path.data() - output.Data.get()) + path.size()] = '\0';
+
+		std::shared_ptr<const char[]> buffer(std::move(output.Data));
+
+		trace.reset();
+		trace.emplace(MD::TracePhase::Validate, backendName);
+		paths = RetainPathsOfType(std::move(paths), PathType::File, buffer);
+
+		if(PathNormalizationEnabled)
+		{
+			//Normalized paths may change in size, so they get their own buffer
+			std::vector<std::string> normalizedPaths(paths.cbegin(), paths.cend());
+			bool changed = false;
+			for(std::string& path : normalizedPaths)
+				changed |= MD::Detail::NormalizeToNFC(path);
+
+			if(changed)
+				return MD::PathList(normalizedPaths);
+		}
+
+		return MD::PathList(std::move(buffer), std::move(paths));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] PreparedDialog<MD::PathList> PrepareOpenFileList(const std::string& title,
+	                                                               const std::string& defaultPathAndFile,
+	                                                               const MD::FilterSet& filters,
+	                                                               const bool allowMultipleSelects)
+	{
+		const Backend* const backend = GetBackend(BackendCapability::OpenFile);
+		if(backend == nullptr)
+			return MD::PathList{};
+
+		std::string titleStorage{};
+		const std::string& safeTitle = SanitizeUTF8(title, titleStorage);
+		const std::string& safePath = GetDefaultPathForBackend(defaultPathAndFile);
+
+		const char separator = backend->PathSeparator;
+
+		return PendingDialog<MD::PathList>
+		{
+			BuildCommand(*backend, [&]{ return backend->OpenFile(safeTitle, safePath, filters.GetData(), allowMultipleSelects); }),
+			[separator, allowMultipleSelects, name = backend->Name](std::optional<ProcessResult> result)
+			{
+				if(!result)
+					return MD::PathList{};
+
+				return GetPathList(std::move(result->Output), separator, allowMultipleSelects, name);
+			},
+			backend->Name,
+			GetDialogRunner(*backend)
+		};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] PreparedDialog<std::vector<std::string>> PrepareOpenFile(const std::string& title,
+		                                                                   const std::string& defaultPathAndFile,
+		                                                                   const MD::FilterSet& filters,
+		                                                                   const bool allowMultipleSelects)
+	{
+		PreparedDialog<MD::PathList> request = PrepareOpenFileList(title, defaultPathAndFile, filters, allowMultipleSelects);
+		if(const MD::PathList* const paths = std::get_if<MD::PathList>(&request))
+			return paths->ToVector();
+
+		PendingDialog<MD::PathList>& dialog = std::get<PendingDialog<MD::PathList>>(request);
+
+		return PendingDialog<std::vector<std::string>>
+		{
+			std::move(dialog.DialogCommand),
+			[finish = std::move(dialog.Finish)](std::optional<ProcessResult> result)
+			{
+				return finish(std::move(result)).ToVector();
+			},
+			dialog.BackendName,
+			dialog.Runner,
+			dialog.Priority
+		};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] PreparedDialog<std::string> PrepareSelectFolder(const std::string& title, const std::string& defaultPath)
+	{
+		const Backend* const backend = GetBackend(BackendCapability::SelectFolder);
+		if(backend == nullptr)
+			return std::string{};
+
+		std::string titleStorage{};
+		const std::string& safeTitle = SanitizeUTF8(title, titleStorage);
+		const std::string& safePath = GetDefaultPathForBackend(defaultPath);
+
+		const char separator = backend->PathSeparator;
+
+		return PendingDialog<std::string>
+		{
+			BuildCommand(*backend, [&]{ return backend->SelectFolder(safeTitle, safePath); }),
+			[separator, name = backend->Name](std::optional<ProcessResult> result)
+			{
+				if(!result)
+					return std::string{};
+
+				std::string path{};
+				{
+					const TraceScope trace(MD::TracePhase::Parse, name);
+					path = GetFirstPath(result->Output.View(), separator);
+				}
+
+				const TraceScope trace(MD::TracePhase::Validate, name);
+				if(path.empty() || !DirExists(path))
+					return std::string{};
+
+				NormalizePath(path);
+				return path;
+			},
+			backend->Name,
+			GetDialogRunner(*backend)
+		};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Map the answer of a message box backend to the selection for the given buttons.
+	/// </summary>
+	/// <param name="answer">1 if accepted, 0 if declined, anything else on error.</param>
+	[[nodiscard]] constexpr MD::Selection GetMsgBoxSelection(const int32_t answer, const MD::Buttons buttons)
+	{
+		if (answer == 1)
+		{
+			if (buttons == MD::Buttons::YesNo)
+				return MD::Selection::Yes;
+			if (buttons == MD::Buttons::OKCancel)
+				return MD::Selection::OK;
+			if (buttons == MD::Buttons::OK)
+				return MD::Selection::OK;
+			if (buttons == MD::Buttons::Quit)
+				return MD::Selection::Quit;
+		}
+		else if (answer == 0)
+		{
+			if (buttons == MD::Buttons::YesNo)
+				return MD::Selection::No;
+			if (buttons == MD::Buttons::OKCancel)
+				return MD::Selection::Cancel;
+			if (buttons == MD::Buttons::OK)
+				return MD::Selection::Quit;
+			if (buttons == MD::Buttons::Quit)
+				return MD::Selection::Quit;
+		}
+
+		return MD::Selection::Error;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] PreparedDialog<MD::Selection> PrepareShowMsgBox(const std::string& title,
+		                                                          const std::string& message,
+		                                                          const MD::Style style,
+		                                                          const MD::Buttons buttons)
+	{
+		const Backend* const backend = GetBackend(BackendCapability::MsgBox);
+		if(backend == nullptr)
+			return MD::Selection::None;
+
+		std::string titleStorage{};
+		std::string messageStorage{};
+		const std::string& safeTitle = SanitizeUTF8(title, titleStorage);
+		const std::string& safeMessage = SanitizeUTF8(message, messageStorage);
+
+		return PendingDialog<MD::Selection>
+		{
+			BuildCommand(*backend, [&]{ return backend->MsgBox(safeTitle, safeMessage, style, buttons); }),
+			[backend, buttons](const std::optional<ProcessResult> result)
+			{
+				if(!result)
+					return MD::Selection::Error;
+
+				const TraceScope trace(MD::TracePhase::Parse, backend->Name);
+				return GetMsgBoxSelection(backend->MsgBoxAnswer(*result), buttons);
+			},
+			backend->Name,
+			GetDialogRunner(*backend),
+			GetMsgBoxPriority(style)
+		};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Python side of the persistent tkinter helper.<br>
+	/// Reads frames (4 byte little endian length + script) from stdin, runs each script with the shared
+	/// withdrawn root and answers with a frame holding everything the script printed.
+	/// tkinter.Tk() is replaced, so the regular one-shot scripts run unchanged.
+	/// </summary>
+	constexpr const char* TKinterHelperScript =
+		"import os,sys,io,struct,contextlib,tkinter\n"
+		"root=tkinter.Tk()\n"
+		"root.withdraw()\n"
+		"tkinter.Tk=lambda *args,**kwargs:root\n"
+		"def readExact(size):\n"
+		"\tdata=b''\n"
+		"\twhile len(data)<size:\n"
+		"\t\tchunk=os.read(0,size-len(data))\n"
+		"\t\tif not chunk:\n"
+		"\t\t\tsys.exit(0)\n"
+		"\t\tdata+=chunk\n"
+		"\treturn data\n"
+		"while True:\n"
+		"\tscript=readExact(struct.unpack('<I',readExact(4))[0]).decode('utf-8','surrogateescape')\n"
+		"\tout=io.StringIO()\n"
+		"\ttry:\n"
+		"\t\twith contextlib.redirect_stdout(out):\n"
+		"\t\t\texec(script,{})\n"
+		"\texcept Exception:\n"
+		"\t\tpass\n"
+		"\troot.update()\n"
+		"\tresult=out.getvalue().encode('utf-8','surrogateescape')\n"
+		"\tframe=memoryview(struct.pack('<I',len(result))+result)\n"
+		"\twhile frame:\n"
+		"\t\tframe=frame[os.write(1,frame):]\n";
+
+	/// <summary>
+	/// Dialog script waiting for or being run by the tkinter helper.
+	/// </summary>
+	struct TKinterHelperRequest
+	{
+		std::string Script;
+		//Receives the output of the script, closed afterwards. The other end acts as the output of the dialog "process"
+		int32_t ResultFd;
+	};
+
+	/// <summary>
+	/// Long-lived Python process with a withdrawn tkinter root, which runs the tkinter dialogs one after another.<br>
+	/// Only its thread starts, talks to and reaps the helper process, other threads may only kill it to cancel a dialog.
+	/// </summary>
+	struct TKinterHelper
+	{
+		std::mutex Mutex{};
+		std::condition_variable Changed{};
+		std::deque<std::shared_ptr<TKinterHelperRequest>> Queue{};
+		std::shared_ptr<TKinterHelperRequest> Active{};
+		std::thread Thread{};
+		bool Stop = false;
+		//Start the helper ahead of the first dialog
+		bool PrestartPending = false;
+
+		//Helper process, 0 if it isn't running. Only reset while holding the mutex, so it can be killed safely
+		pid_t Pid = 0;
+		//Connected to stdin and stdout of the helper process
+		int32_t Socket = -1;
+
+		TKinterHelper() = default;
+		TKinterHelper(const TKinterHelper&) = delete;
+		TKinterHelper& operator=(const TKinterHelper&) = delete;
+
+		~TKinterHelper()
+		{
+			{
+				const std::lock_guard lock(Mutex);
+				Stop = true;
+				if(Pid > 0)
+					kill(-Pid, SIGKILL);
+			}
+			Changed.notify_all();
+
+			if(Thread.joinable())
+				Thread.join();
+
+			if(Pid > 0)
+			{
+				close(Socket);
+				static_cast<void>(WaitForExitStatus(Pid));
+			}
+		}
+	};
+
+	void RunTKinterHelper(TKinterHelper& helper);
+
+	[[nodiscard]] TKinterHelper& GetTKinterHelper()
+	{
+		static TKinterHelper helper{};
+
+		return helper;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Start the thread of the helper if it isn't running yet, the mutex of the helper must be held.
+	/// </summary>
+	void StartTKinterHelperThread(TKinterHelper& helper)
+	{
+		if(!helper.Thread.joinable())
+			helper.Thread = std::thread(RunTKinterHelper, std::ref(helper));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool SendAll(const int32_t fd, const char* data, std::size_t size)
+	{
+		while(size > 0)
+		{
+			//MSG_NOSIGNAL, a closed peer must not raise SIGPIPE in the application
+			const ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+			if(sent < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				return false;
+			}
+
+			data += sent;
+			size -= static_cast<std::size_t>(sent);
+		}
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool ReceiveAll(const int32_t fd, char* data, std::size_t size)
+	{
+		while(size > 0)
+		{
+			const ssize_t received = recv(fd, data, size, 0);
+			if(received == 0 || (received < 0 && errno != EINTR))
+				return false;
+			if(received < 0)
+				continue;
+
+			data += received;
+			size -= static_cast<std::size_t>(received);
+		}
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void StartTKinterHelperProcess(TKinterHelper& helper)
+	{
+		std::array<int, 2> sockets{};
+		if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) != 0)
+			return;
+
+		const int32_t nullFd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+		const pid_t pid = nullFd < 0 ? -1 : StartProcess({GetBackendInfo().Python3, "-S", "-c", TKinterHelperScript}, sockets[1], sockets[1], nullFd);
+
+		close(sockets[1]);
+		if(nullFd >= 0)
+			close(nullFd);
+
+		if(pid < 0)
+		{
+			close(sockets[0]);
+			return;
+		}
+
+		const std::lock_guard lock(helper.Mutex);
+		helper.Pid = pid;
+		helper.Socket = sockets[0];
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void StopTKinterHelperProcess(TKinterHelper& helper)
+	{
+		if(helper.Pid <= 0)
+			return;
+
+		close(helper.Socket);
+
+		const std::lock_guard lock(helper.Mutex);
+		kill(-helper.Pid, SIGKILL);
+		static_cast<void>(WaitForExitStatus(helper.Pid));
+		helper.Pid = 0;
+		helper.Socket = -1;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Run a script in the helper, (re)starting the helper if needed.
+	/// </summary>
+	/// <param name="helper">Helper to use.</param>
+	/// <param name="script">Script to run.</param>
+	/// <returns>Output of the script or std::nullopt if the helper failed or died while running it.</returns>
+	[[nodiscard]] std::optional<std::string> RunTKinterHelperScript(TKinterHelper& helper, const std::string& script)
+	{
+		std::array<char, 4> header{};
+		const uint32_t scriptSize = static_cast<uint32_t>(script.size());
+		for(std::size_t i = 0; i < header.size(); ++i)
+			header[i] = static_cast<char>((scriptSize >> (8 * i)) & 0xFFu);
+
+		//A helper which died while idle (e.g. got killed) only shows up once the request is sent, retry once with a new one
+		for(uint32_t attempt = 0; attempt < 2; ++attempt)
+		{
+			if(helper.Pid <= 0)
+				StartTKinterHelperProcess(helper);
+			if(helper.Pid <= 0)
+				return std::nullopt;
+
+			if(!SendAll(helper.Socket, header.data(), header.size()) || !SendAll(helper.Socket, script.data(), script.size()))
+			{
+				StopTKinterHelperProcess(helper);
+				continue;
+			}
+
+			std::string output{};
+			if(ReceiveAll(helper.Socket, header.data(), header.size()))
+			{
+				uint32_t outputSize = 0;
+				for(std::size_t i = 0; i < header.size(); ++i)
+					outputSize |= static_cast<uint32_t>(static_cast<unsigned char>(header[i])) << (8 * i);
+
+				output.resize(outputSize);
+				if(ReceiveAll(helper.Socket, output.data(), output.size()))
+					return output;
+			}
+
+			//Died or got killed while the dialog was open, don't show it again
+			StopTKinterHelperProcess(helper);
+			return std::nullopt;
+		}
+
+		return std::nullopt;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void RunTKinterHelper(TKinterHelper& helper)
+	{
+		std::unique_lock lock(helper.Mutex);
+		while(!helper.Stop)
+		{
+			if(helper.Queue.empty())
+			{
+				const bool enabled = TKinterHelperEnabled;
+				if(!enabled && helper.Pid > 0)
+				{
+					lock.unlock();
+					StopTKinterHelperProcess(helper);
+					lock.lock();
+				}
+				else if(enabled && helper.PrestartPending)
+				{
+					helper.PrestartPending = false;
+					//Detection runs here, so enabling the helper never blocks the caller
+					if(helper.Pid <= 0 && GetBackendInfo().TKinter3)
+					{
+						lock.unlock();
+						StartTKinterHelperProcess(helper);
+						lock.lock();
+					}
+				}
+				else
+					helper.Changed.wait(lock);
+
+				continue;
+			}
+
+			helper.Active = std::move(helper.Queue.front());
+			helper.Queue.pop_front();
+			const std::shared_ptr<TKinterHelperRequest> request = helper.Active;
+			lock.unlock();
+
+			const std::optional<std::string> output = RunTKinterHelperScript(helper, request->Script);
+
+			lock.lock();
+			helper.Active.reset();
+			lock.unlock();
+
+			//A failed helper yields no output at all, just like a process which failed to run the dialog
+			if(output)
+				static_cast<void>(SendAll(request->ResultFd, output->data(), output->size()));
+			close(request->ResultFd);
+
+			lock.lock();
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Cancel a request of the helper, a dialog which is already open gets closed by killing the helper.
+	/// </summary>
+	void CancelTKinterHelperRequest(const std::shared_ptr<TKinterHelperRequest>& request)
+	{
+		TKinterHelper& helper = GetTKinterHelper();
+
+		const std::lock_guard lock(helper.Mutex);
+		if(helper.Active == request)
+		{
+			if(helper.Pid > 0)
+				kill(-helper.Pid, SIGKILL);
+			return;
+		}
+
+		const auto it = std::find(helper.Queue.begin(), helper.Queue.end(), request);
+		if(it != helper.Queue.end())
+		{
+			close((*it)->ResultFd);
+			helper.Queue.erase(it);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Queue the script of a tkinter dialog command for the helper.
+	/// </summary>
+	/// <param name="command">tkinter dialog command, its last argument is the script.</param>
+	/// <param name="cancel">Receives the function cancelling the request.</param>
+	/// <returns>Running "process" whose output delivers the result, its pid is 0 as there is no process to wait for.</returns>
+	[[nodiscard]] std::optional<RunningProcess> SubmitTKinterHelperRequest(const Command& command, std::function<void()>& cancel)
+	{
+		std::array<int, 2> sockets{};
+		if(command.empty() || socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) != 0)
+			return std::nullopt;
+
+		std::shared_ptr<TKinterHelperRequest> request = std::make_shared<TKinterHelperRequest>(TKinterHelperRequest{command.back(), sockets[1]});
+		cancel = [request]{ CancelTKinterHelperRequest(request); };
+
+		TKinterHelper& helper = GetTKinterHelper();
+		{
+			const std::lock_guard lock(helper.Mutex);
+			StartTKinterHelperThread(helper);
+			helper.Queue.push_back(request);
+		}
+		helper.Changed.notify_all();
+
+		return RunningProcess{0, sockets[0]};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Dialog requested from the xdg-desktop-portal, shared by the ProcessReactor driving it and the function cancelling it.<br>
+	/// Once its call was sent only the reactor touches it, except for the cancel pipe.
+	/// </summary>
+	struct PortalRequest
+	{
+		//Reset once the dialog is done
+		std::unique_ptr<DBusSession> Session{};
+		int32_t BusFd = -1;
+		uint32_t CallSerial = 0;
+		//Object path of the request, empty until the portal answered the call
+		std::string Handle{};
+		std::chrono::steady_clock::time_point ReplyDeadline = std::chrono::steady_clock::time_point::max();
+		//Receives the selected paths, closed by the reactor once all of them were sent
+		int32_t ResultFd = -1;
+		//Set once the dialog is done
+		std::optional<std::string> Result{};
+		std::size_t ResultSent = 0;
+		//Written to cancel the dialog
+		std::array<int, 2> CancelFds{-1, -1};
+
+		PortalRequest() = default;
+		PortalRequest(const PortalRequest&) = delete;
+		PortalRequest& operator=(const PortalRequest&) = delete;
+
+		~PortalRequest()
+		{
+			for(const int32_t fd : {ResultFd, CancelFds[0], CancelFds[1]})
+			{
+				if(fd >= 0)
+					close(fd);
+			}
+		}
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Append an entry to an a{sv} dictionary.
+	/// </summary>
+	/// <param name="dbus">libdbus.</param>
+	/// <param name="options">Dictionary to append to.</param>
+	/// <param name="key">Name of the entry.</param>
+	/// <param name="signature">Signature of the value.</param>
+	/// <param name="appendValue">Appends the value to the given variant.</param>
+	template<typename F>
+	void AppendPortalOption(const DBusLibrary& dbus, DBusMessageIter& options, const char* const key, const char* const signature, F&& appendValue)
+	{
+		DBusMessageIter entry{};
+		DBusMessageIter variant{};
+		dbus.MessageIterOpenContainer(&options, DBusTypeDictEntry, nullptr, &entry);
+		dbus.MessageIterAppendBasic(&entry, DBusTypeString, &key);
+		dbus.MessageIterOpenContainer(&entry, DBusTypeVariant, signature, &variant);
+		appendValue(variant);
+		dbus.MessageIterCloseContainer(&entry, &variant);
+		dbus.MessageIterCloseContainer(&options, &entry);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Append the filters of a file chooser command as a(sa(us)), every pattern is a glob (type 0).
+	/// </summary>
+	void AppendPortalFilters(const DBusLibrary& dbus, DBusMessageIter& variant, const Command& request)
+	{
+		DBusMessageIter filters{};
+		dbus.MessageIterOpenContainer(&variant, DBusTypeArray, "(sa(us))", &filters);
+
+		for(std::size_t i = static_cast<std::size_t>(FileChooserField::Filters); i + 1 < request.size(); i += 2)
+		{
+			DBusMessageIter filter{};
+			DBusMessageIter patterns{};
+			const char* const name = request[i].c_str();
+			dbus.MessageIterOpenContainer(&filters, DBusTypeStruct, nullptr, &filter);
+			dbus.MessageIterAppendBasic(&filter, DBusTypeString, &name);
+			dbus.MessageIterOpenContainer(&filter, DBusTypeArray, "(us)", &patterns);
+
+			std::string_view extensions = request[i + 1];
+			while(!extensions.empty())
+			{
+				const std::size_t end = std::min(extensions.find(';'), extensions.size());
+				const std::string pattern(extensions.substr(0, end));
+				extensions.remove_prefix(std::min(end + 1, extensions.size()));
+				if(pattern.empty())
+					continue;
+
+				DBusMessageIter entry{};
+				const uint32_t globType = 0;
+				const char* const globPattern = pattern.c_str();
+				dbus.MessageIterOpenContainer(&patterns, DBusTypeStruct, nullptr, &entry);
+				dbus.MessageIterAppendBasic(&entry, DBusTypeUInt32, &globType);
+				dbus.MessageIterAppendBasic(&entry, DBusTypeString, &globPattern);
+				dbus.MessageIterCloseContainer(&patterns, &entry);
+			}
+
+			dbus.MessageIterCloseContainer(&filter, &patterns);
+			dbus.MessageIterCloseContainer(&filters, &filter);
+		}
+
+		dbus.MessageIterCloseContainer(&variant, &filters);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Build the OpenFile or SaveFile call of the FileChooser portal for a file chooser command.
+	/// </summary>
+	[[nodiscard]] DBusMessagePtr BuildPortalCall(const DBusLibrary& dbus, const Command& request)
+	{
+		DBusMessagePtr call(dbus.MessageNewMethodCall(PortalService, PortalObject, PortalFileChooserInterface,
+		                                              GetFileChooserField(request, FileChooserField::Method).c_str()),
+		                    dbus.MessageUnref);
+		if(!call)
+			return call;
+
+		DBusMessageIter args{};
+		DBusMessageIter options{};
+		const char* const parentWindow = GetFileChooserField(request, FileChooserField::ParentWindow).c_str();
+		const char* const title = GetFileChooserField(request, FileChooserField::Title).c_str();
+		dbus.MessageIterInitAppend(call.get(), &args);
+		dbus.MessageIterAppendBasic(&args, DBusTypeString, &parentWindow);
+		dbus.MessageIterAppendBasic(&args, DBusTypeString, &title);
+		dbus.MessageIterOpenContainer(&args, DBusTypeArray, "{sv}", &options);
+
+		const uint32_t enabled = 1;
+		const auto appendEnabled = [&dbus, &enabled](DBusMessageIter& variant){ dbus.MessageIterAppendBasic(&variant, DBusTypeBoolean, &enabled); };
+		if(!GetFileChooserField(request, FileChooserField::Multiple).empty())
+			AppendPortalOption(dbus, options, "multiple", "b", appendEnabled);
+		if(!GetFileChooserField(request, FileChooserField::Directory).empty())
+			AppendPortalOption(dbus, options, "directory", "b", appendEnabled);
+
+		//Folders are passed as null terminated byte arrays, as paths don't need to be valid UTF-8
+		const std::string& folder = GetFileChooserField(request, FileChooserField::Folder);
+		if(!folder.empty())
+		{
+			AppendPortalOption(dbus, options, "current_folder", "ay", [&dbus, &folder](DBusMessageIter& variant)
+			{
+				DBusMessageIter bytes{};
+				const char* const data = folder.c_str();
+				dbus.MessageIterOpenContainer(&variant, DBusTypeArray, "y", &bytes);
+				dbus.MessageIterAppendFixedArray(&bytes, DBusTypeByte, &data, static_cast<int32_t>(folder.size() + 1));
+				dbus.MessageIterCloseContainer(&variant, &bytes);
+			});
+		}
+
+		const char* const name = GetFileChooserField(request, FileChooserField::Name).c_str();
+		if(*name != '\0')
+			AppendPortalOption(dbus, options, "current_name", "s", [&dbus, &name](DBusMessageIter& variant){ dbus.MessageIterAppendBasic(&variant, DBusTypeString, &name); });
+
+		if(request.size() > static_cast<std::size_t>(FileChooserField::Filters))
+			AppendPortalOption(dbus, options, "filters", "a(sa(us))", [&dbus, &request](DBusMessageIter& variant){ AppendPortalFilters(dbus, variant, request); });
+
+		if(!dbus.MessageIterCloseContainer(&args, &options))
+			call.reset();
+
+		return call;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Append the path of a file:// URI to the output, terminated by '\0'.<br>
+	/// Other URIs are skipped as they can't be opened as files.
+	/// </summary>
+	void AppendFileURIPath(std::string& output, std::string_view uri)
+	{
+		constexpr std::string_view scheme = "file://";
+		if(uri.substr(0, scheme.size()) != scheme)
+			return;
+
+		//Skip the host, if any
+		uri.remove_prefix(scheme.size());
+		const std::size_t pathStart = uri.find('/');
+		if(pathStart == std::string_view::npos)
+			return;
+		uri.remove_prefix(pathStart);
+
+		const auto hexValue = [](const char c) -> int32_t
+		{
+			if(c >= '0' && c <= '9')
+				return c - '0';
+			if(c >= 'a' && c <= 'f')
+				return c - 'a' + 10;
+			if(c >= 'A' && c <= 'F')
+				return c - 'A' + 10;
+			return -1;
+		};
+
+		for(std::size_t i = 0; i < uri.size(); ++i)
+		{
+			if(uri[i] == '%' && i + 2 < uri.size() && hexValue(uri[i + 1]) >= 0 && hexValue(uri[i + 2]) >= 0)
+			{
+				output.push_back(static_cast<char>(hexValue(uri[i + 1]) * 16 + hexValue(uri[i + 2])));
+				i += 2;
+			}
+			else
+				output.push_back(uri[i]);
+		}
+
+		output.push_back('\0');
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Retrieve the selected paths from the Response signal of a portal request.
+	/// </summary>
+	/// <returns>Paths terminated by '\0', empty if the dialog was cancelled or failed.</returns>
+	[[nodiscard]] std::string GetPortalResponsePaths(const DBusLibrary& dbus, DBusMessage* const response)
+	{
+		DBusMessageIter args{};
+		if(!dbus.MessageIterInit(response, &args) || dbus.MessageIterGetArgType(&args) != DBusTypeUInt32)
+			return {};
+
+		//0 is success, 1 cancelled by the user and 2 any other failure
+		uint32_t responseCode = 1;
+		dbus.MessageIterGetBasic(&args, &responseCode);
+		if(responseCode != 0 || !dbus.MessageIterNext(&args) || dbus.MessageIterGetArgType(&args) != DBusTypeArray)
+			return {};
+
+		std::string output{};
+		DBusMessageIter results{};
+		for(dbus.MessageIterRecurse(&args, &results); dbus.MessageIterGetArgType(&results) == DBusTypeDictEntry; dbus.MessageIterNext(&results))
+		{
+			DBusMessageIter entry{};
+			dbus.MessageIterRecurse(&results, &entry);
+
+			const char* key = nullptr;
+			dbus.MessageIterGetBasic(&entry, &key);
+			if(std::strcmp(key, "uris") != 0 || !dbus.MessageIterNext(&entry))
+				continue;
+
+			DBusMessageIter variant{};
+			dbus.MessageIterRecurse(&entry, &variant);
+			if(dbus.MessageIterGetArgType(&variant) != DBusTypeArray)
+				continue;
+
+			DBusMessageIter uris{};
+			for(dbus.MessageIterRecurse(&variant, &uris); dbus.MessageIterGetArgType(&uris) == DBusTypeString; dbus.MessageIterNext(&uris))
+			{
+				const char* uri = nullptr;
+				dbus.MessageIterGetBasic(&uris, &uri);
+				AppendFileURIPath(output, uri);
+			}
+		}
+
+		return output;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	//libdbus waits this long for a reply by default
+	constexpr std::chrono::seconds PortalReplyTimeout{25};
+
+	/// <summary>
+	/// Connect to the session bus and send the call opening the dialog, without waiting for the reply.
+	/// </summary>
+	/// <returns>Whether the call was sent.</returns>
+	[[nodiscard]] bool SendPortalCall(PortalRequest& request, const Command& command)
+	{
+		const DBusLibrary* const dbus = GetDBusLibrary();
+		if(dbus == nullptr)
+			return false;
+
+		request.Session = std::make_unique<DBusSession>(*dbus);
+		DBusConnection* const connection = request.Session->Get();
+		if(connection == nullptr || !dbus->ConnectionGetUnixFd(connection, &request.BusFd))
+			return false;
+
+		//Subscribed before the call, so the Response can't be missed when the dialog closes immediately
+		dbus->BusAddMatch(connection, "type='signal',interface='org.freedesktop.portal.Request',member='Response'", nullptr);
+
+		const DBusMessagePtr call = BuildPortalCall(*dbus, command);
+		if(!call || !dbus->ConnectionSend(connection, call.get(), &request.CallSerial))
+			return false;
+
+		dbus->ConnectionFlush(connection);
+		request.ReplyDeadline = std::chrono::steady_clock::now() + PortalReplyTimeout;
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void FinishPortalRequest(PortalRequest& request, std::string paths)
+	{
+		request.Result = std::move(paths);
+		request.Session.reset();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Process the messages received for a portal dialog, called by the ProcessReactor whenever it wakes up.<br>
+	/// Every message libdbus already read gets processed, so polling the bus fd afterwards can't miss one.
+	/// </summary>
+	/// <param name="request">Portal dialog which isn't done yet.</param>
+	/// <param name="cancel">Whether to close the dialog.</param>
+	/// <param name="now">Time the reactor woke up.</param>
+	void DispatchPortalRequest(PortalRequest& request, const bool cancel, const std::chrono::steady_clock::time_point now)
+	{
+		const DBusLibrary& dbus = *GetDBusLibrary();
+		DBusConnection* const connection = request.Session->Get();
+
+		if(cancel)
+		{
+			if(!request.Handle.empty())
+			{
+				const DBusMessagePtr closeCall(dbus.MessageNewMethodCall(PortalService, request.Handle.c_str(), PortalRequestInterface, "Close"), dbus.MessageUnref);
+				if(closeCall)
+				{
+					static_cast<void>(dbus.ConnectionSend(connection, closeCall.get(), nullptr));
+					dbus.ConnectionFlush(connection);
+				}
+			}
+
+			FinishPortalRequest(request, {});
+			return;
+		}
+
+		if(!dbus.ConnectionReadWrite(connection, 0))
+		{
+			FinishPortalRequest(request, {});
+			return;
+		}
+
+		while(true)
+		{
+			const DBusMessagePtr message(dbus.ConnectionPopMessage(connection), dbus.MessageUnref);
+			if(!message)
+				break;
+
+			if(dbus.MessageIsSignal(message.get(), "org.freedesktop.DBus.Local", "Disconnected"))
+			{
+				FinishPortalRequest(request, {});
+				return;
+			}
+
+			//The portal sends the reply before the Response signal of the request
+			if(request.Handle.empty())
+			{
+				if(dbus.MessageGetReplySerial(message.get()) != request.CallSerial)
+					continue;
+
+				DBusMessageIter result{};
+				if(dbus.MessageGetType(message.get()) != DBusMessageTypeMethodReturn || !dbus.MessageIterInit(message.get(), &result) ||
+				   dbus.MessageIterGetArgType(&result) != DBusTypeObjectPath)
+				{
+					FinishPortalRequest(request, {});
+					return;
+				}
+
+				const char* requestPath = nullptr;
+				dbus.MessageIterGetBasic(&result, &requestPath);
+				request.Handle = requestPath;
+				continue;
+			}
+
+			const char* const path = dbus.MessageGetPath(message.get());
+			if(path != nullptr && request.Handle == path && dbus.MessageIsSignal(message.get(), PortalRequestInterface, "Response"))
+			{
+				FinishPortalRequest(request, GetPortalResponsePaths(dbus, message.get()));
+				return;
+			}
+		}
+
+		if(request.Handle.empty() && request.ReplyDeadline <= now)
+			FinishPortalRequest(request, {});
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Send as much of the result of a finished portal dialog as its socket takes without blocking.<br>
+	/// The reactor may be the reader of the socket itself, so it must never wait for it.
+	/// </summary>
+	/// <returns>Whether the result was sent completely or can't be sent at all.</returns>
+	[[nodiscard]] bool SendPortalResult(PortalRequest& request)
+	{
+		const std::string& result = *request.Result;
+		while(request.ResultSent < result.size())
+		{
+			const ssize_t sent = send(request.ResultFd, result.data() + request.ResultSent, result.size() - request.ResultSent,
+			                          MSG_NOSIGNAL | MSG_DONTWAIT);
+			if(sent < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				return errno != EAGAIN && errno != EWOULDBLOCK;
+			}
+
+			request.ResultSent += static_cast<std::size_t>(sent);
+		}
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	//Defined with the ProcessReactor, which waits on the D-Bus connections of all portal dialogs
+	[[nodiscard]] bool WatchPortalRequest(std::shared_ptr<PortalRequest> request);
+
+	/// <summary>
+	/// Send the call of a portal dialog and let the ProcessReactor wait for its response,
+	/// the D-Bus round trips replace starting a backend process.
+	/// </summary>
+	/// <param name="command">File chooser command describing the dialog.</param>
+	/// <param name="cancel">Receives the function cancelling the dialog.</param>
+	/// <returns>Running "process" whose output delivers the selected paths, its pid is 0 as there is no process to wait for.</returns>
+	[[nodiscard]] std::optional<RunningProcess> SubmitPortalRequest(const Command& command, std::function<void()>& cancel)
+	{
+		if(command.size() < static_cast<std::size_t>(FileChooserField::Filters))
+			return std::nullopt;
+
+		const std::shared_ptr<PortalRequest> request = std::make_shared<PortalRequest>();
+		if(pipe2(request->CancelFds.data(), O_CLOEXEC | O_NONBLOCK) != 0)
+			return std::nullopt;
+
+		std::array<int, 2> sockets{};
+		if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) != 0)
+			return std::nullopt;
+
+		request->ResultFd = sockets[1];
+		if(!SendPortalCall(*request, command) || !WatchPortalRequest(request))
+		{
+			close(sockets[0]);
+			return std::nullopt;
+		}
+
+		cancel = [request]
+		{
+			const char byte = 0;
+			static_cast<void>(write(request->CancelFds[1], &byte, 1));
+		};
+
+		return RunningProcess{0, sockets[0]};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Node of a GSList, as returned by gtk_file_chooser_get_filenames().
+	/// </summary>
+	struct GSList
+	{
+		void* Data;
+		GSList* Next;
+	};
+
+	constexpr int32_t GTKFileChooserActionOpen = 0;
+	constexpr int32_t GTKFileChooserActionSave = 1;
+	constexpr int32_t GTKFileChooserActionSelectFolder = 2;
+	constexpr int32_t GTKResponseAccept = -3;
+
+	/// <summary>
+	/// Functions of GTK 3 or GTK 4 (and the GLib libraries it depends on) used by the GTK backend.<br>
+	/// Members ending in 3 or 4 are only loaded for that GTK version.
+	/// </summary>
+	struct GTKLibrary
+	{
+		bool GTK4;
+
+		int32_t(*InitCheck3)(int* argc, char*** argv);
+		int32_t(*InitCheck4)();
+		void*(*FileChooserNativeNew)(const char* title, void* parent, int32_t action, const char* acceptLabel, const char* cancelLabel);
+		void(*NativeDialogShow)(void* dialog);
+		void(*NativeDialogHide)(void* dialog);
+		void(*FileChooserSetSelectMultiple)(void* chooser, int32_t selectMultiple);
+		void(*FileChooserSetCurrentName)(void* chooser, const char* name);
+		void(*FileChooserAddFilter)(void* chooser, void* filter);
+		void*(*FileFilterNew)();
+		void(*FileFilterSetName)(void* filter, const char* name);
+		void(*FileFilterAddPattern)(void* filter, const char* pattern);
+		unsigned long(*SignalConnectData)(void* instance, const char* signal, void(*handler)(), void* data, void(*destroyData)(void* data, void* closure), int32_t flags);
+		void(*ObjectUnref)(void* object);
+		uint32_t(*IdleAdd)(int32_t(*function)(void* data), void* data);
+		void*(*MainLoopNew)(void* context, int32_t isRunning);
+		void(*MainLoopRun)(void* loop);
+		void(*MainLoopQuit)(void* loop);
+		void(*Free)(void* memory);
+
+		int32_t(*FileChooserSetCurrentFolder3)(void* chooser, const char* folder);
+		void(*FileChooserSetDoOverwriteConfirmation3)(void* chooser, int32_t confirm);
+		GSList*(*FileChooserGetFilenames3)(void* chooser);
+		void(*SListFree3)(GSList* list);
+
+		int32_t(*FileChooserSetCurrentFolder4)(void* chooser, void* folder, void* error);
+		void*(*FileChooserGetFiles4)(void* chooser);
+		void*(*FileNewForPath4)(const char* path);
+		char*(*FileGetPath4)(void* file);
+		uint32_t(*ListModelGetNItems4)(void* list);
+		void*(*ListModelGetItem4)(void* list, uint32_t position);
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Load GTK 3, or GTK 4 if GTK 3 is unavailable, on first use. It stays loaded afterwards.<br>
+	/// ModernDialogs doesn't link against GTK, without it the GTK backend is just unavailable.
+	/// </summary>
+	/// <returns>GTK or nullptr if it is unavailable.</returns>
+	[[nodiscard]] const GTKLibrary* GetGTKLibrary()
+	{
+		static const std::optional<GTKLibrary> library = []() -> std::optional<GTKLibrary>
+		{
+			GTKLibrary gtk{};
+			void* handle = dlopen("libgtk-3.so.0", RTLD_LAZY | RTLD_LOCAL);
+			if(handle == nullptr)
+			{
+				handle = dlopen("libgtk-4.so.1", RTLD_LAZY | RTLD_LOCAL);
+				gtk.GTK4 = true;
+			}
+			if(handle == nullptr)
+				return std::nullopt;
+
+			//GLib and GObject symbols resolve through the dependencies of GTK
+			bool loaded = LoadSymbol(handle, "gtk_file_chooser_native_new", gtk.FileChooserNativeNew) &&
+			              LoadSymbol(handle, "gtk_native_dialog_show", gtk.NativeDialogShow) &&
+			              LoadSymbol(handle, "gtk_native_dialog_hide", gtk.NativeDialogHide) &&
+			              LoadSymbol(handle, "gtk_file_chooser_set_select_multiple", gtk.FileChooserSetSelectMultiple) &&
+			              LoadSymbol(handle, "gtk_file_chooser_set_current_name", gtk.FileChooserSetCurrentName) &&
+			              LoadSymbol(handle, "gtk_file_chooser_add_filter", gtk.FileChooserAddFilter) &&
+			              LoadSymbol(handle, "gtk_file_filter_new", gtk.FileFilterNew) &&
+			              LoadSymbol(handle, "gtk_file_filter_set_name", gtk.FileFilterSetName) &&
+			              LoadSymbol(handle, "gtk_file_filter_add_pattern", gtk.FileFilterAddPattern) &&
+			              LoadSymbol(handle, "g_signal_connect_data", gtk.SignalConnectData) &&
+			              LoadSymbol(handle, "g_object_unref", gtk.ObjectUnref) &&
+			              LoadSymbol(handle, "g_idle_add", gtk.IdleAdd) &&
+			              LoadSymbol(handle, "g_main_loop_new", gtk.MainLoopNew) &&
+			              LoadSymbol(handle, "g_main_loop_run", gtk.MainLoopRun) &&
+			              LoadSymbol(handle, "g_main_loop_quit", gtk.MainLoopQuit) &&
+			              LoadSymbol(handle, "g_free", gtk.Free);
+
+			if(!gtk.GTK4)
+			{
+				loaded = loaded &&
+				         LoadSymbol(handle, "gtk_init_check", gtk.InitCheck3) &&
+				         LoadSymbol(handle, "gtk_file_chooser_set_current_folder", gtk.FileChooserSetCurrentFolder3) &&
+				         LoadSymbol(handle, "gtk_file_chooser_set_do_overwrite_confirmation", gtk.FileChooserSetDoOverwriteConfirmation3) &&
+				         LoadSymbol(handle, "gtk_file_chooser_get_filenames", gtk.FileChooserGetFilenames3) &&
+				         LoadSymbol(handle, "g_slist_free", gtk.SListFree3);
+			}
+			else
+			{
+				loaded = loaded &&
+				         LoadSymbol(handle, "gtk_init_check", gtk.InitCheck4) &&
+				         LoadSymbol(handle, "gtk_file_chooser_set_current_folder", gtk.FileChooserSetCurrentFolder4) &&
+				         LoadSymbol(handle, "gtk_file_chooser_get_files", gtk.FileChooserGetFiles4) &&
+				         LoadSymbol(handle, "g_file_new_for_path", gtk.FileNewForPath4) &&
+				         LoadSymbol(handle, "g_file_get_path", gtk.FileGetPath4) &&
+				         LoadSymbol(handle, "g_list_model_get_n_items", gtk.ListModelGetNItems4) &&
+				         LoadSymbol(handle, "g_list_model_get_item", gtk.ListModelGetItem4);
+			}
+
+			if(!loaded)
+			{
+				dlclose(handle);
+				return std::nullopt;
+			}
+
+			return gtk;
+		}();
+
+		return library ? &*library : nullptr;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Thread running the GTK main loop. GTK is initialized once on it and every GTK call happens on it,
+	/// other threads only hand over work through g_idle_add().
+	/// </summary>
+	struct GTKContext
+	{
+		std::mutex Mutex{};
+		std::thread Thread{};
+		//Set once the thread finished initializing GTK
+		bool Started = false;
+		bool Initialized = false;
+		void* MainLoop = nullptr;
+
+		GTKContext() = default;
+		GTKContext(const GTKContext&) = delete;
+		GTKContext& operator=(const GTKContext&) = delete;
+
+		~GTKContext()
+		{
+			if(MainLoop != nullptr)
+				GetGTKLibrary()->MainLoopQuit(MainLoop);
+
+			if(Thread.joinable())
+				Thread.join();
+		}
+	};
+
+	[[nodiscard]] GTKContext& GetGTKContext()
+	{
+		static GTKContext context{};
+
+		return context;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Start the GTK thread on first use and wait until GTK is initialized.
+	/// </summary>
+	/// <returns>Whether GTK is ready to show dialogs.</returns>
+	[[nodiscard]] bool StartGTK()
+	{
+		const GTKLibrary* const gtk = GetGTKLibrary();
+		if(gtk == nullptr)
+			return false;
+
+		GTKContext& context = GetGTKContext();
+
+		const std::lock_guard lock(context.Mutex);
+		if(context.Started)
+			return context.Initialized;
+
+		std::promise<void*> mainLoop{};
+		std::future<void*> started = mainLoop.get_future();
+		context.Thread = std::thread([gtk, mainLoop = std::move(mainLoop)]() mutable
+		{
+			const bool initialized = gtk->GTK4 ? gtk->InitCheck4() : gtk->InitCheck3(nullptr, nullptr);
+			void* const loop = initialized ? gtk->MainLoopNew(nullptr, 0) : nullptr;
+			mainLoop.set_value(loop);
+
+			if(loop != nullptr)
+				gtk->MainLoopRun(loop);
+		});
+
+		context.MainLoop = started.get();
+		context.Initialized = context.MainLoop != nullptr;
+		context.Started = true;
+
+		return context.Initialized;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	std::atomic<bool> GTKBackendEnabled{false};
+
+	[[nodiscard]] bool UseGTKBackend()
+	{
+		return GTKBackendEnabled && GetBackendInfo().GraphicMode && StartGTK();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// File chooser shown by the GTK thread.
+	/// </summary>
+	struct GTKRequest
+	{
+		Command Request{};
+		//Receives the selected paths, closed once the dialog is done
+		int32_t ResultFd = -1;
+
+		//Only accessed on the GTK thread
+		void* Dialog = nullptr;
+		bool Done = false;
+	};
+
+	using GTKRequestData = std::shared_ptr<GTKRequest>;
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Hand the selected paths to the waiting dialog and release the file chooser, runs on the GTK thread.
+	/// </summary>
+	void FinishGTKDialog(GTKRequest& request, const std::string& paths)
+	{
+		if(request.Done)
+			return;
+		request.Done = true;
+
+		static_cast<void>(SendAll(request.ResultFd, paths.data(), paths.size()));
+		close(request.ResultFd);
+
+		if(request.Dialog != nullptr)
+		{
+			//Also drops the data of the response handler
+			GetGTKLibrary()->ObjectUnref(request.Dialog);
+			request.Dialog = nullptr;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Retrieve the selected paths of a file chooser, each terminated by '\0'.
+	/// </summary>
+	[[nodiscard]] std::string GetGTKSelectedPaths(const GTKLibrary& gtk, void* const chooser)
+	{
+		std::string paths{};
+
+		if(!gtk.GTK4)
+		{
+			GSList* const filenames = gtk.FileChooserGetFilenames3(chooser);
+			for(GSList* node = filenames; node != nullptr; node = node->Next)
+			{
+				paths += static_cast<const char*>(node->Data);
+				paths.push_back('\0');
+				gtk.Free(node->Data);
+			}
+			gtk.SListFree3(filenames);
+
+			return paths;
+		}
+
+		void* const files = gtk.FileChooserGetFiles4(chooser);
+		const uint32_t count = gtk.ListModelGetNItems4(files);
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			void* const file = gtk.ListModelGetItem4(files, i);
+			char* const path = gtk.FileGetPath4(file);
+			//Files without a local path (e.g. remote locations) can't be returned
+			if(path != nullptr)
+			{
+				paths += path;
+				paths.push_back('\0');
+				gtk.Free(path);
+			}
+			gtk.ObjectUnref(file);
+		}
+		gtk.ObjectUnref(files);
+
+		return paths;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void OnGTKDialogResponse(void* const dialog, const int32_t response, void* const data)
+	{
+		const GTKLibrary& gtk = *GetGTKLibrary();
+		GTKRequest& request = **static_cast<GTKRequestData*>(data);
+
+		FinishGTKDialog(request, response == GTKResponseAccept ? GetGTKSelectedPaths(gtk, dialog) : std::string{});
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Create and show the file chooser of a request, runs on the GTK thread.
+	/// </summary>
+	int32_t ShowGTKDialog(void* const data)
+	{
+		const std::unique_ptr<GTKRequestData> requestData(static_cast<GTKRequestData*>(data));
+		GTKRequest& request = **requestData;
+		if(request.Done)
+			return 0;
+
+		const GTKLibrary& gtk = *GetGTKLibrary();
+		const Command& command = request.Request;
+
+		int32_t action = GTKFileChooserActionOpen;
+		if(GetFileChooserField(command, FileChooserField::Method) == "SaveFile")
+			action = GTKFileChooserActionSave;
+		else if(!GetFileChooserField(command, FileChooserField::Directory).empty())
+			action = GTKFileChooserActionSelectFolder;
+
+		void* const dialog = gtk.FileChooserNativeNew(GetFileChooserField(command, FileChooserField::Title).c_str(), nullptr, action, nullptr, nullptr);
+		if(dialog == nullptr)
+		{
+			FinishGTKDialog(request, {});
+			return 0;
+		}
+		request.Dialog = dialog;
+
+		gtk.FileChooserSetSelectMultiple(dialog, !GetFileChooserField(command, FileChooserField::Multiple).empty());
+
+		const std::string& folder = GetFileChooserField(command, FileChooserField::Folder);
+		if(!folder.empty())
+		{
+			if(!gtk.GTK4)
+				static_cast<void>(gtk.FileChooserSetCurrentFolder3(dialog, folder.c_str()));
+			else
+			{
+				void* const file = gtk.FileNewForPath4(folder.c_str());
+				static_cast<void>(gtk.FileChooserSetCurrentFolder4(dialog, file, nullptr));
+				gtk.ObjectUnref(file);
+			}
+		}
+
+		if(action == GTKFileChooserActionSave)
+		{
+			const std::string& name = GetFileChooserField(command, FileChooserField::Name);
+			if(!name.empty())
+				gtk.FileChooserSetCurrentName(dialog, name.c_str());
+			//GTK 4 always confirms overwriting
+			if(!gtk.GTK4)
+				gtk.FileChooserSetDoOverwriteConfirmation3(dialog, 1);
+		}
+
+		for(std::size_t i = static_cast<std::size_t>(FileChooserField::Filters); i + 1 < command.size(); i += 2)
+		{
+			void* const filter = gtk.FileFilterNew();
+			gtk.FileFilterSetName(filter, command[i].c_str());
+
+			std::string_view extensions = command[i + 1];
+			while(!extensions.empty())
+			{
+				const std::size_t end = std::min(extensions.find(';'), extensions.size());
+				const std::string pattern(extensions.substr(0, end));
+				extensions.remove_prefix(std::min(end + 1, extensions.size()));
+				if(!pattern.empty())
+					gtk.FileFilterAddPattern(filter, pattern.c_str());
+			}
+
+			gtk.FileChooserAddFilter(dialog, filter);
+			//GTK 3 sinks the floating reference of the filter, GTK 4 takes its own reference
+			if(gtk.GTK4)
+				gtk.ObjectUnref(filter);
+		}
+
+		gtk.SignalConnectData(dialog, "response", reinterpret_cast<void(*)()>(OnGTKDialogResponse), new GTKRequestData(*requestData),
+		                      [](void* const responseData, void*){ delete static_cast<GTKRequestData*>(responseData); }, 0);
+		gtk.NativeDialogShow(dialog);
+
+		return 0;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Close the file chooser of a request, runs on the GTK thread.
+	/// </summary>
+	int32_t CancelGTKDialog(void* const data)
+	{
+		const std::unique_ptr<GTKRequestData> requestData(static_cast<GTKRequestData*>(data));
+		GTKRequest& request = **requestData;
+
+		//Hiding aborts the dialog without emitting a response
+		if(!request.Done && request.Dialog != nullptr)
+			GetGTKLibrary()->NativeDialogHide(request.Dialog);
+		FinishGTKDialog(request, {});
+
+		return 0;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Show a file chooser on the GTK thread.
+	/// </summary>
+	/// <param name="command">File chooser command describing the dialog.</param>
+	/// <param name="cancel">Receives the function cancelling the dialog.</param>
+	/// <returns>Running "process" whose output delivers the selected paths, its pid is 0 as there is no process to wait for.</returns>
+	[[nodiscard]] std::optional<RunningProcess> SubmitGTKRequest(const Command& command, std::function<void()>& cancel)
+	{
+		if(command.size() < static_cast<std::size_t>(FileChooserField::Filters) || !StartGTK())
+			return std::nullopt;
+
+		std::array<int, 2> sockets{};
+		if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) != 0)
+			return std::nullopt;
+
+		const GTKRequestData request = std::make_shared<GTKRequest>();
+		request->Request = command;
+		request->ResultFd = sockets[1];
+
+		const GTKLibrary& gtk = *GetGTKLibrary();
+		gtk.IdleAdd(ShowGTKDialog, new GTKRequestData(request));
+
+		cancel = [&gtk, request]{ gtk.IdleAdd(CancelGTKDialog, new GTKRequestData(request)); };
+
+		return RunningProcess{0, sockets[0]};
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	std::atomic<int64_t> DialogTimeoutMilliseconds{0};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] std::chrono::steady_clock::time_point GetDialogDeadline()
+	{
+		const int64_t timeout = DialogTimeoutMilliseconds;
+		if(timeout <= 0)
+			return std::chrono::steady_clock::time_point::max();
+
+		return std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Convert a deadline into a timeout for poll().
+	/// </summary>
+	/// <returns>Milliseconds until the deadline (rounded up) or -1 if there is no deadline.</returns>
+	[[nodiscard]] int32_t GetPollTimeout(const std::chrono::steady_clock::time_point deadline)
+	{
+		if(deadline == std::chrono::steady_clock::time_point::max())
+			return -1;
+
+		const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+		return static_cast<int32_t>(std::clamp<int64_t>(remaining, 0, std::numeric_limits<int32_t>::max()));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Shared state of a dialog process, so it can be terminated from any thread.
+	/// </summary>
+	struct ProcessControl
+	{
+		std::mutex Mutex{};
+		pid_t Pid = 0;
+		//Set before the process gets reaped, its pid must not be signalled afterwards
+		bool Exited = false;
+		bool Terminated = false;
+		//Set instead of the pid if the dialog isn't run by a process of its own
+		std::function<void()> CancelRequest{};
+		//Set while the dialog waits for a slot of the DialogScheduler
+		std::optional<uint64_t> QueuedSequence{};
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Kill the process group of the dialog process, or prevent it from being started if it isn't running yet.
+	/// </summary>
+	void TerminateDialogProcess(ProcessControl& control)
+	{
+		const std::lock_guard lock(control.Mutex);
+		control.Terminated = true;
+		if(control.Pid > 0 && !control.Exited)
+			kill(-control.Pid, SIGKILL);
+		else if(control.CancelRequest && !control.Exited)
+			control.CancelRequest();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool WasTerminated(ProcessControl& control)
+	{
+		const std::lock_guard lock(control.Mutex);
+		return control.Terminated;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] std::optional<RunningProcess> SpawnControlledProcess(const Command& command,
+	                                                                   ProcessControl& control,
+	                                                                   const std::string_view backendName,
+	                                                                   const DialogRunner runner)
+	{
+		const TraceScope trace(MD::TracePhase::Spawn, backendName);
+
+		const std::lock_guard lock(control.Mutex);
+		if(control.Terminated)
+			return std::nullopt;
+
+		std::optional<RunningProcess> process{};
+		switch(runner)
+		{
+		case DialogRunner::Process:
+			process = SpawnProcess(command);
+			break;
+
+		case DialogRunner::TKinterHelper:
+			process = SubmitTKinterHelperRequest(command, control.CancelRequest);
+			break;
+
+		case DialogRunner::Portal:
+			process = SubmitPortalRequest(command, control.CancelRequest);
+			break;
+
+		case DialogRunner::GTK:
+			process = SubmitGTKRequest(command, control.CancelRequest);
+			break;
+		}
+		if(process)
+		{
+			control.Pid = process->Pid;
+			if(IsTracing())
+			{
+				process->Backend = backendName;
+				process->StartTime = std::chrono::steady_clock::now();
+			}
+		}
+
+		return process;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] int32_t ReapControlledProcess(const RunningProcess& process, ProcessControl& control)
+	{
+		{
+			const std::lock_guard lock(control.Mutex);
+			control.Exited = true;
+		}
+
+		//Dialogs run by the tkinter helper have no process of their own
+		const int32_t exitStatus = process.Pid > 0 ? WaitForExitStatus(process.Pid) : 0;
+
+		if(process.StartTime != std::chrono::steady_clock::time_point{})
+			EmitTraceEvent({MD::TracePhase::Run, process.Backend, {}, process.StartTime, std::chrono::steady_clock::now()});
+
+		return exitStatus;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Limits the number of dialogs shown at the same time, see MD::SetMaxConcurrentDialogs().<br>
+	/// Dialogs beyond the limit wait ordered by priority and then by arrival.
+	/// </summary>
+	class DialogScheduler
+	{
+	public:
+		[[nodiscard]] bool IsLimited() const noexcept
+		{
+			return m_maxConcurrent != 0;
+		}
+
+		void SetMaxConcurrent(const std::size_t maxConcurrent)
+		{
+			std::vector<std::function<void()>> starts{};
+			{
+				const std::lock_guard lock(m_mutex);
+				m_maxConcurrent = maxConcurrent;
+				//A higher limit lets waiting dialogs in right away
+				while(!m_waiting.empty() && HasFreeSlot())
+					starts.push_back(PopNext());
+			}
+
+			for(const std::function<void()>& start : starts)
+				start();
+		}
+
+		/// <summary>
+		/// Run start once a slot is free, which may be right away on this thread or later on the thread
+		/// releasing a slot. The dialog started by start must call Release() once it is closed.<br>
+		/// Returns the sequence number to pass to Cancel() if the dialog has to wait.
+		/// </summary>
+		std::optional<uint64_t> Submit(const int32_t priority, std::function<void()> start, std::function<void()> cancel = {})
+		{
+			{
+				const std::lock_guard lock(m_mutex);
+				if(!m_waiting.empty() || !HasFreeSlot())
+				{
+					const uint64_t sequence = m_nextSequence++;
+					m_waiting.push_back({priority, sequence, std::move(start), std::move(cancel)});
+					std::push_heap(m_waiting.begin(), m_waiting.end(), RunsLater);
+					return sequence;
+				}
+
+				++m_running;
+			}
+
+			start();
+			return std::nullopt;
+		}
+
+		/// <summary>
+		/// Remove a waiting dialog and run its cancel function instead of starting it.
+		/// Does nothing if the dialog was already started.
+		/// </summary>
+		void Cancel(const uint64_t sequence)
+		{
+			std::function<void()> cancel{};
+			{
+				const std::lock_guard lock(m_mutex);
+				const auto it = std::find_if(m_waiting.begin(), m_waiting.end(),
+				                             [sequence](const WaitingDialog& dialog){ return dialog.Sequence == sequence; });
+				if(it == m_waiting.end())
+					return;
+
+				cancel = std::move(it->Cancel);
+				m_waiting.erase(it);
+				std::make_heap(m_waiting.begin(), m_waiting.end(), RunsLater);
+			}
+
+			if(cancel)
+				cancel();
+		}
+
+		/// <summary>
+		/// Block until a slot is free, it must be handed back with Release().
+		/// </summary>
+		void Acquire(const int32_t priority)
+		{
+			std::mutex mutex{};
+			std::condition_variable granted{};
+			bool isGranted = false;
+
+			Submit(priority, [&]
+			{
+				//Notified under the lock, the waiter may destroy the condition variable as soon as it sees the flag
+				const std::lock_guard lock(mutex);
+				isGranted = true;
+				granted.notify_one();
+			});
+
+			std::unique_lock lock(mutex);
+			granted.wait(lock, [&]{ return isGranted; });
+		}
+
+		void Release()
+		{
+			std::function<void()> start{};
+			{
+				const std::lock_guard lock(m_mutex);
+				--m_running;
+				if(m_waiting.empty() || !HasFreeSlot())
+					return;
+
+				start = PopNext();
+			}
+
+			start();
+		}
+
+	private:
+		struct WaitingDialog
+		{
+			int32_t Priority;
+			uint64_t Sequence;
+			std::function<void()> Start;
+			std::function<void()> Cancel;
+		};
+
+		static bool RunsLater(const WaitingDialog& lhs, const WaitingDialog& rhs) noexcept
+		{
+			if(lhs.Priority != rhs.Priority)
+				return lhs.Priority < rhs.Priority;
+
+			return lhs.Sequence > rhs.Sequence;
+		}
+
+		[[nodiscard]] bool HasFreeSlot() const noexcept
+		{
+			return m_maxConcurrent == 0 || m_running < m_maxConcurrent;
+		}
+
+		//Takes the slot for the next waiting dialog, m_mutex must be held
+		[[nodiscard]] std::function<void()> PopNext()
+		{
+			std::pop_heap(m_waiting.begin(), m_waiting.end(), RunsLater);
+			std::function<void()> start = std::move(m_waiting.back().Start);
+			m_waiting.pop_back();
+			++m_running;
+
+			return start;
+		}
+
+		std::mutex m_mutex{};
+		std::atomic<std::size_t> m_maxConcurrent{0};
+		std::size_t m_running = 0;
+		uint64_t m_nextSequence = 0;
+		std::vector<WaitingDialog> m_waiting{};
+	};
+
+	DialogScheduler Scheduler{};
+
+	//Set on the thread of the ProcessReactor, which must never wait for a slot as it finishes the dialogs holding them
+	thread_local bool IsProcessReactorThread = false;
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T>
+	[[nodiscard]] T RunPendingDialogNow(const PendingDialog<T>& dialog)
+	{
+		ProcessControl control{};
+		const std::optional<RunningProcess> process = SpawnControlledProcess(dialog.DialogCommand, control, dialog.BackendName, dialog.Runner);
+		if(!process)
+			return dialog.Finish(std::nullopt);
+
+		std::chrono::steady_clock::time_point deadline = GetDialogDeadline();
+		ProcessOutput output{};
+		while(true)
+		{
+			pollfd pollFd{process->OutputFd, POLLIN, 0};
+			const int32_t ready = poll(&pollFd, 1, GetPollTimeout(deadline));
+			if(ready == 0)
+			{
+				TerminateDialogProcess(control);
+				deadline = std::chrono::steady_clock::time_point::max();
+				continue;
+			}
+			if(ready < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				break;
+			}
+
+			if(ReadProcessOutput(process->OutputFd, output) == ReadStatus::EndOfFile)
+				break;
+		}
+		close(process->OutputFd);
+
+		const int32_t exitStatus = ReapControlledProcess(*process, control);
+
+		if(WasTerminated(control))
+			return GetCancelledResult<T>();
+
+		return dialog.Finish(GetProcessResult(std::move(output), exitStatus));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T>
+	[[nodiscard]] T RunPendingDialog(const PendingDialog<T>& dialog)
+	{
+		if(!Scheduler.IsLimited() || IsProcessReactorThread)
+			return RunPendingDialogNow(dialog);
+
+		Scheduler.Acquire(dialog.Priority);
+
+		struct SlotGuard
+		{
+			~SlotGuard()
+			{
+				Scheduler.Release();
+			}
+		} slot{};
+
+		return RunPendingDialogNow(dialog);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T>
+	[[nodiscard]] T RunDialog(PreparedDialog<T> request)
+	{
+		if(T* const result = std::get_if<T>(&request))
+			return std::move(*result);
+
+		return RunPendingDialog(std::get<PendingDialog<T>>(request));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	using ProcessCompletion = std::function<void(std::optional<ProcessResult>)>;
+
+	struct WatchedProcess
+	{
+		//Spawned by the background thread, so the process isn't tied to the lifetime of the launching thread
+		Command DialogCommand;
+		std::string_view BackendName;
+		DialogRunner Runner;
+		std::shared_ptr<ProcessControl> Control;
+		std::chrono::steady_clock::time_point Deadline;
+		ProcessCompletion OnExit;
+
+		RunningProcess Process{};
+		ProcessOutput Output{};
+	};
+
+	/// <summary>
+	/// Single background thread which waits on the output of all asynchronously opened dialogs
+	/// and on the D-Bus connections of all portal dialogs.<br>
+	/// It is only started once the first asynchronous or portal dialog is opened.
+	/// </summary>
+	struct ProcessReactor
+	{
+		std::mutex Mutex{};
+		std::vector<WatchedProcess> Added{};
+		std::vector<std::shared_ptr<PortalRequest>> AddedPortals{};
+		//Run by the thread before it waits again, see SpawnOnProcessReactor()
+		std::vector<std::packaged_task<void()>> Tasks{};
+		//Self-pipe used to wake the thread up when processes were added or on shutdown
+		std::array<int, 2> WakeFds{-1, -1};
+		std::thread Thread{};
+		bool Stop = false;
+
+		ProcessReactor() = default;
+		ProcessReactor(const ProcessReactor&) = delete;
+		ProcessReactor& operator=(const ProcessReactor&) = delete;
+
+		~ProcessReactor()
+		{
+			if(Thread.joinable())
+			{
+				{
+					const std::lock_guard lock(Mutex);
+					Stop = true;
+				}
+				Wake();
+				Thread.join();
+			}
+
+			for(const int fd : WakeFds)
+			{
+				if(fd >= 0)
+					close(fd);
+			}
+		}
+
+		void Wake() const
+		{
+			constexpr char wakeByte = 0;
+			while(write(WakeFds[1], &wakeByte, 1) < 0 && errno == EINTR)
+				;
+		}
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] ProcessReactor& GetProcessReactor()
+	{
+		//The reactor posts callbacks to the completion queue until its thread is joined, so the queue has to be destroyed after it
+		static_cast<void>(GetCompletionQueue());
+		static ProcessReactor reactor{};
+		return reactor;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void RunProcessReactor(ProcessReactor& reactor)
+	{
+		IsProcessReactorThread = true;
+
+		std::vector<WatchedProcess> watched{};
+		std::vector<WatchedProcess> added{};
+		std::vector<std::shared_ptr<PortalRequest>> portals{};
+		std::vector<std::packaged_task<void()>> tasks{};
+		std::vector<pollfd> pollFds{};
+		std::array<char, 4096> buffer{};
+
+		while(true)
+		{
+			const std::size_t firstAddedPortal = portals.size();
+			bool stop = false;
+			{
+				const std::lock_guard lock(reactor.Mutex);
+				stop = reactor.Stop;
+
+				added.swap(reactor.Added);
+				portals.insert(portals.end(), reactor.AddedPortals.begin(), reactor.AddedPortals.end());
+				reactor.AddedPortals.clear();
+				tasks.swap(reactor.Tasks);
+			}
+
+			//Tasks are run even when stopping, their threads are waiting for them
+			for(std::packaged_task<void()>& task : tasks)
+				task();
+			tasks.clear();
+			if(stop)
+				break;
+
+			//Sending their call may have read messages already, which polling wouldn't report
+			for(std::size_t i = firstAddedPortal; i < portals.size(); ++i)
+				DispatchPortalRequest(*portals[i], false, std::chrono::steady_clock::now());
+
+			for(WatchedProcess& process : added)
+			{
+				const std::optional<RunningProcess> runningProcess = SpawnControlledProcess(process.DialogCommand, *process.Control, process.BackendName, process.Runner);
+				if(!runningProcess)
+				{
+					process.OnExit(std::nullopt);
+					continue;
+				}
+
+				process.Process = *runningProcess;
+				process.DialogCommand.clear();
+				watched.push_back(std::move(process));
+			}
+			added.clear();
+
+			std::chrono::steady_clock::time_point nextDeadline = std::chrono::steady_clock::time_point::max();
+			pollFds.clear();
+			pollFds.push_back({reactor.WakeFds[0], POLLIN, 0});
+			for(const WatchedProcess& process : watched)
+			{
+				pollFds.push_back({process.Process.OutputFd, POLLIN, 0});
+				nextDeadline = std::min(nextDeadline, process.Deadline);
+			}
+			const std::size_t firstPortalFd = pollFds.size();
+			for(const std::shared_ptr<PortalRequest>& portal : portals)
+			{
+				if(portal->Result)
+				{
+					pollFds.push_back({portal->ResultFd, POLLOUT, 0});
+					pollFds.push_back({-1, 0, 0});
+					continue;
+				}
+
+				pollFds.push_back({portal->BusFd, POLLIN, 0});
+				pollFds.push_back({portal->CancelFds[0], POLLIN, 0});
+				if(portal->Handle.empty())
+					nextDeadline = std::min(nextDeadline, portal->ReplyDeadline);
+			}
+
+			if(poll(pollFds.data(), pollFds.size(), GetPollTimeout(nextDeadline)) < 0)
+				continue;
+
+			if(pollFds[0].revents != 0)
+			{
+				while(read(reactor.WakeFds[0], buffer.data(), buffer.size()) > 0)
+					;
+			}
+
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			for(WatchedProcess& process : watched)
+			{
+				if(process.Deadline <= now)
+				{
+					TerminateDialogProcess(*process.Control);
+					process.Deadline = std::chrono::steady_clock::time_point::max();
+				}
+			}
+
+			std::size_t portalFd = firstPortalFd;
+			for(auto it = portals.begin(); it != portals.end(); portalFd += 2)
+			{
+				PortalRequest& portal = **it;
+				if(!portal.Result)
+					DispatchPortalRequest(portal, pollFds[portalFd + 1].revents != 0, now);
+
+				if(!portal.Result || !SendPortalResult(portal))
+				{
+					++it;
+					continue;
+				}
+
+				//The cancel function may keep the request alive, the reader must see the end of the result now
+				close(portal.ResultFd);
+				portal.ResultFd = -1;
+				it = portals.erase(it);
+			}
+
+			std::vector<WatchedProcess> finished{};
+			std::size_t index = 0;
+			for(auto it = watched.begin(); it != watched.end(); ++index)
+			{
+				if(pollFds[index + 1].revents == 0)
+				{
+					++it;
+					continue;
+				}
+
+				if(ReadProcessOutput(it->Process.OutputFd, it->Output) != ReadStatus::EndOfFile)
+				{
+					++it;
+					continue;
+				}
+
+				finished.push_back(std::move(*it));
+				it = watched.erase(it);
+			}
+
+			for(WatchedProcess& process : finished)
+			{
+				close(process.Process.OutputFd);
+				const int32_t exitStatus = ReapControlledProcess(process.Process, *process.Control);
+				process.OnExit(GetProcessResult(std::move(process.Output), exitStatus));
+			}
+		}
+
+		//Dialogs still open on shutdown are killed through PR_SET_PDEATHSIG once this thread is gone
+		for(const WatchedProcess& process : watched)
+			close(process.Process.OutputFd);
+
+		//Portal dialogs aren't processes of this application, they have to be closed explicitly
+		for(const std::shared_ptr<PortalRequest>& portal : portals)
+		{
+			if(!portal->Result)
+				DispatchPortalRequest(*portal, true, std::chrono::steady_clock::now());
+
+			close(portal->ResultFd);
+			portal->ResultFd = -1;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Start the thread of the reactor unless it is already running, reactor.Mutex must be held.
+	/// </summary>
+	/// <returns>Whether the thread is running.</returns>
+	[[nodiscard]] bool StartProcessReactor(ProcessReactor& reactor)
+	{
+		if(reactor.Thread.joinable())
+			return true;
+
+		if(pipe2(reactor.WakeFds.data(), O_CLOEXEC | O_NONBLOCK) != 0)
+		{
+			reactor.WakeFds = {-1, -1};
+			return false;
+		}
+
+		reactor.Thread = std::thread(RunProcessReactor, std::ref(reactor));
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Spawn a dialog process on the thread of the reactor and wait for it.<br>
+	/// PR_SET_PDEATHSIG kills a process once the thread which spawned it exits, the reactor thread lives until shutdown.
+	/// </summary>
+	[[nodiscard]] std::optional<RunningProcess> SpawnOnProcessReactor(const Command& command,
+	                                                                  ProcessControl& control,
+	                                                                  const std::string_view backendName,
+	                                                                  const DialogRunner runner)
+	{
+		if(IsProcessReactorThread)
+			return SpawnControlledProcess(command, control, backendName, runner);
+
+		std::optional<RunningProcess> process{};
+		std::packaged_task<void()> task([&]{ process = SpawnControlledProcess(command, control, backendName, runner); });
+		std::future<void> spawned = task.get_future();
+
+		ProcessReactor& reactor = GetProcessReactor();
+		{
+			const std::lock_guard lock(reactor.Mutex);
+			if(reactor.Stop || !StartProcessReactor(reactor))
+				return SpawnControlledProcess(command, control, backendName, runner);
+
+			reactor.Tasks.push_back(std::move(task));
+		}
+
+		reactor.Wake();
+		spawned.get();
+
+		return process;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool WatchPortalRequest(std::shared_ptr<PortalRequest> request)
+	{
+		ProcessReactor& reactor = GetProcessReactor();
+
+		{
+			const std::lock_guard lock(reactor.Mutex);
+			if(!StartProcessReactor(reactor))
+				return false;
+
+			reactor.AddedPortals.push_back(std::move(request));
+		}
+
+		reactor.Wake();
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Start the given dialog process in the background and call onExit once it has exited.<br>
+	/// onExit receives std::nullopt if the process could not be started.
+	/// </summary>
+	void WatchProcess(Command command,
+	                  const std::string_view backendName,
+	                  const DialogRunner runner,
+	                  std::shared_ptr<ProcessControl> control,
+	                  const std::chrono::steady_clock::time_point deadline,
+	                  ProcessCompletion onExit)
+	{
+		ProcessReactor& reactor = GetProcessReactor();
+
+		{
+			const std::lock_guard lock(reactor.Mutex);
+			if(!StartProcessReactor(reactor))
+			{
+				onExit(std::nullopt);
+				return;
+			}
+
+			reactor.Added.push_back({std::move(command), backendName, runner, std::move(control), deadline, std::move(onExit)});
+		}
+
+		reactor.Wake();
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T>
+	void LaunchDialogNow(PendingDialog<T> dialog, std::shared_ptr<ProcessControl> control, std::function<void(T)> onComplete)
+	{
+		auto onExit = [control, finish = std::move(dialog.Finish), onComplete = std::move(onComplete)](std::optional<ProcessResult> result)
+		{
+			if(WasTerminated(*control))
+				onComplete(GetCancelledResult<T>());
+			else
+				onComplete(finish(std::move(result)));
+		};
+
+		WatchProcess(std::move(dialog.DialogCommand), dialog.BackendName, dialog.Runner, std::move(control), GetDialogDeadline(), std::move(onExit));
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T>
+	void LaunchDialog(PreparedDialog<T> request, std::shared_ptr<ProcessControl> control, std::function<void(T)> onComplete)
+	{
+		if(T* const result = std::get_if<T>(&request))
+		{
+			onComplete(std::move(*result));
+			return;
+		}
+
+		PendingDialog<T>& dialog = std::get<PendingDialog<T>>(request);
+		if(!Scheduler.IsLimited())
+		{
+			LaunchDialogNow<T>(std::move(dialog), std::move(control), std::move(onComplete));
+			return;
+		}
+
+		const int32_t priority = dialog.Priority;
+		const std::optional<uint64_t> sequence = Scheduler.Submit(priority, [dialog = std::make_shared<PendingDialog<T>>(std::move(dialog)), control, onComplete]
+		{
+			LaunchDialogNow<T>(std::move(*dialog), control, [onComplete](T result)
+			{
+				Scheduler.Release();
+				onComplete(std::move(result));
+			});
+		}, [onComplete]{ onComplete(GetCancelledResult<T>()); });
+		if(!sequence)
+			return;
+
+		bool wasTerminated = false;
+		{
+			const std::lock_guard lock(control->Mutex);
+			wasTerminated = control->Terminated;
+			if(!wasTerminated)
+				control->QueuedSequence = sequence;
+		}
+
+		//Cancelled while it was being queued
+		if(wasTerminated)
+			Scheduler.Cancel(*sequence);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Cancel a dialog started by LaunchDialog(), a dialog still waiting for a slot is removed from the queue
+	/// and completes with the cancelled result right away.
+	/// </summary>
+	void CancelDialog(ProcessControl& control)
+	{
+		//Terminated first, LaunchDialog() cancels the dialog itself if it queues it afterwards
+		TerminateDialogProcess(control);
+
+		std::optional<uint64_t> sequence{};
+		{
+			const std::lock_guard lock(control.Mutex);
+			sequence = std::exchange(control.QueuedSequence, std::nullopt);
+		}
+		if(sequence)
+			Scheduler.Cancel(*sequence);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T>
+	[[nodiscard]] std::future<T> LaunchDialogFuture(PreparedDialog<T> request)
+	{
+		auto promise = std::make_shared<std::promise<T>>();
+		std::future<T> future = promise->get_future();
+
+		LaunchDialog<T>(std::move(request), std::make_shared<ProcessControl>(), [promise](T result){ promise->set_value(std::move(result)); });
+
+		return future;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	template<typename T>
+	void LaunchDialogCallback(std::function<void(T)> callback, PreparedDialog<T> request)
+	{
+		LaunchDialog<T>(std::move(request), std::make_shared<ProcessControl>(),
+		                [callback = std::move(callback)](T result){ DeliverResult(callback, std::move(result)); });
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Message box shared by identical ShowMsgBox() calls while it is waiting or shown, see MD::SetMsgBoxCoalescingEnabled().
+	/// </summary>
+	struct CoalescedMsgBox
+	{
+		std::string Title;
+		std::string Message;
+		MD::Style Style;
+		MD::Buttons Buttons;
+		//Number of calls sharing the dialog, each with its callback in Waiters
+		std::size_t Count = 0;
+		std::vector<std::function<void(MD::Selection)>> Waiters{};
+	};
+
+	std::atomic<bool> MsgBoxCoalescingEnabled{false};
+	std::mutex CoalescedMsgBoxesMutex{};
+	std::vector<std::shared_ptr<CoalescedMsgBox>> CoalescedMsgBoxes{};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void FinishCoalescedMsgBox(const std::shared_ptr<CoalescedMsgBox>& msgBox, const MD::Selection selection)
+	{
+		std::vector<std::function<void(MD::Selection)>> waiters{};
+		{
+			const std::lock_guard lock(CoalescedMsgBoxesMutex);
+			CoalescedMsgBoxes.erase(std::find(CoalescedMsgBoxes.begin(), CoalescedMsgBoxes.end(), msgBox));
+			waiters.swap(msgBox->Waiters);
+		}
+
+		for(const std::function<void(MD::Selection)>& waiter : waiters)
+			waiter(selection);
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Show a message box, or join an identical one which is already waiting or shown.<br>
+	/// onComplete is called with the selection of the shared dialog.
+	/// </summary>
+	void LaunchCoalescedMsgBox(const std::string& title,
+	                           const std::string& message,
+	                           const MD::Style style,
+	                           const MD::Buttons buttons,
+	                           std::function<void(MD::Selection)> onComplete)
+	{
+		std::shared_ptr<CoalescedMsgBox> msgBox{};
+		{
+			const std::lock_guard lock(CoalescedMsgBoxesMutex);
+			for(const std::shared_ptr<CoalescedMsgBox>& coalesced : CoalescedMsgBoxes)
+			{
+				if(coalesced->Style == style && coalesced->Buttons == buttons && coalesced->Title == title && coalesced->Message == message)
+				{
+					++coalesced->Count;
+					coalesced->Waiters.push_back(std::move(onComplete));
+					return;
+				}
+			}
+
+			//Registered before preparing, so identical calls arriving meanwhile already join it
+			msgBox = std::make_shared<CoalescedMsgBox>(CoalescedMsgBox{title, message, style, buttons, 1, {}});
+			msgBox->Waiters.push_back(std::move(onComplete));
+			CoalescedMsgBoxes.push_back(msgBox);
+		}
+
+		//Prepared on the calling thread, so the backend detection never runs on the thread starting waiting dialogs
+		PreparedDialog<MD::Selection> request = PrepareShowMsgBox(title, message, style, buttons);
+		if(const MD::Selection* const result = std::get_if<MD::Selection>(&request))
+		{
+			FinishCoalescedMsgBox(msgBox, *result);
+			return;
+		}
+
+		auto dialog = std::make_shared<PendingDialog<MD::Selection>>(std::move(std::get<PendingDialog<MD::Selection>>(request)));
+		const int32_t priority = dialog->Priority;
+		Scheduler.Submit(priority, [msgBox, dialog]
+		{
+			std::size_t count = 0;
+			{
+				const std::lock_guard lock(CoalescedMsgBoxesMutex);
+				count = msgBox->Count;
+			}
+
+			//Identical calls arrived while the dialog was waiting, show how often the message occurred
+			if(count > 1)
+			{
+				PreparedDialog<MD::Selection> counted = PrepareShowMsgBox(msgBox->Title, msgBox->Message + "\n\n(Occurred " + std::to_string(count) + " times)",
+				                                                          msgBox->Style, msgBox->Buttons);
+				if(PendingDialog<MD::Selection>* const countedDialog = std::get_if<PendingDialog<MD::Selection>>(&counted))
+					*dialog = std::move(*countedDialog);
+			}
+
+			LaunchDialogNow<MD::Selection>(std::move(*dialog), std::make_shared<ProcessControl>(), [msgBox](const MD::Selection selection)
+			{
+				Scheduler.Release();
+				FinishCoalescedMsgBox(msgBox, selection);
+			});
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] MD::Selection ShowCoalescedMsgBox(const std::string& title,
+	                                                const std::string& message,
+	                                                const MD::Style style,
+	                                                const MD::Buttons buttons)
+	{
+		std::mutex mutex{};
+		std::condition_variable finished{};
+		std::optional<MD::Selection> selection{};
+
+		LaunchCoalescedMsgBox(title, message, style, buttons, [&](const MD::Selection result)
+		{
+			//Notified under the lock, the waiter may return as soon as it sees the selection
+			const std::lock_guard lock(mutex);
+			selection = result;
+			finished.notify_one();
+		});
+
+		std::unique_lock lock(mutex);
+		finished.wait(lock, [&]{ return selection.has_value(); });
+
+		return *selection;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Dialog shown by the dialog objects (MD::SaveFileDialog, ...).<br>
+	/// The dialog is prepared once and its command reused for every Show().
+	/// It is only prepared again if the backend, its runner or the window the command attaches to changed.
+	/// </summary>
+	template<typename T>
+	class ReusableDialog
+	{
+	public:
+		ReusableDialog(const BackendCapability capability, std::function<PreparedDialog<T>()> prepare)
+			: m_capability(capability), m_prepare(std::move(prepare))
+		{
+			static_cast<void>(GetPrepared());
+		}
+
+		[[nodiscard]] T Show() const
+		{
+			const std::shared_ptr<const Prepared> prepared = GetPrepared();
+			if(const T* const result = std::get_if<T>(&prepared->Dialog))
+				return *result;
+
+			return RunPendingDialog(std::get<PendingDialog<T>>(prepared->Dialog));
+		}
+
+	private:
+		struct Prepared
+		{
+			PreparedDialog<T> Dialog;
+			const Backend* DialogBackend;
+			DialogRunner Runner;
+			uint64_t Parent;
+			std::optional<std::string> WindowId;
+		};
+
+		[[nodiscard]] std::shared_ptr<const Prepared> GetPrepared() const
+		{
+			const Backend* const backend = GetBackend(m_capability);
+			const DialogRunner runner = backend != nullptr ? GetDialogRunner(*backend) : DialogRunner::Process;
+			const uint64_t parent = ParentWindow;
+
+			std::shared_ptr<const Prepared> prepared{};
+			{
+				const std::lock_guard lock(m_mutex);
+				prepared = m_prepared;
+			}
+
+			if(prepared && prepared->DialogBackend == backend && prepared->Runner == runner && prepared->Parent == parent &&
+			   (!prepared->WindowId || *prepared->WindowId == GetActiveWindowId()))
+				return prepared;
+
+			AttachedWindowId.reset();
+			PreparedDialog<T> dialog = m_prepare();
+			prepared = std::make_shared<const Prepared>(Prepared{std::move(dialog), backend, runner, parent, std::exchange(AttachedWindowId, std::nullopt)});
+
+			const std::lock_guard lock(m_mutex);
+			m_prepared = prepared;
+
+			return prepared;
+		}
+
+		BackendCapability m_capability;
+		std::function<PreparedDialog<T>()> m_prepare;
+		mutable std::mutex m_mutex{};
+		mutable std::shared_ptr<const Prepared> m_prepared{};
+	};
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+/// <summary>
+/// State shared between a DialogHandle and the code completing its dialog.
+/// </summary>
+template<typename T>
+struct MD::DialogHandle<T>::State
+{
+	std::mutex Mutex{};
+	std::condition_variable Finished{};
+	std::optional<T> Result{};
+#ifndef _WIN32
+	std::shared_ptr<ProcessControl> Control = std::make_shared<ProcessControl>();
+#endif
+
+	void SetResult(T result)
+	{
+		{
+			const std::lock_guard lock(Mutex);
+			if(Result)
+				return;
+			Result = std::move(result);
+		}
+
+		Finished.notify_all();
+	}
+};
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+namespace
+{
+#ifdef _WIN32
+	template<typename T, typename F>
+	[[nodiscard]] MD::DialogHandle<T> LaunchDialogHandle(F&& showDialog)
+	{
+		auto state = std::make_shared<typename MD::DialogHandle<T>::State>();
+
+		std::thread([state, showDialog = std::forward<F>(showDialog)]()
+		{
+			state->SetResult(showDialog());
+		}).detach();
+
+		return MD::DialogHandle<T>(std::move(state));
+	}
+#else
+	template<typename T>
+	[[nodiscard]] MD::DialogHandle<T> LaunchDialogHandle(PreparedDialog<T> request)
+	{
+		auto state = std::make_shared<typename MD::DialogHandle<T>::State>();
+
+		LaunchDialog<T>(std::move(request), state->Control, [state](T result){ state->SetResult(std::move(result)); });
+
+		return MD::DialogHandle<T>(std::move(state));
+	}
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+/// <summary>
+/// State of a DialogRequest, driven entirely by the thread polling the request.
+/// </summary>
+template<typename T>
+struct MD::DialogRequest<T>::State
+{
+	std::optional<T> Result{};
+#ifdef _WIN32
+	MD::DialogHandle<T> Handle{};
+#else
+	std::function<T(std::optional<ProcessResult>)> Finish{};
+	std::optional<RunningProcess> Process{};
+	ProcessControl Control{};
+	std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::time_point::max();
+	ProcessOutput Output{};
+
+	State() = default;
+	State(const State&) = delete;
+	State& operator=(const State&) = delete;
+
+	~State()
+	{
+		if(!Process)
+			return;
+
+		//Abandoned requests close their dialog
+		TerminateDialogProcess(Control);
+		close(Process->OutputFd);
+		static_cast<void>(ReapControlledProcess(*Process, Control));
+	}
+
+	void Complete()
+	{
+		close(Process->OutputFd);
+		const int32_t exitStatus = ReapControlledProcess(*Process, Control);
+		Process.reset();
+
+		if(WasTerminated(Control))
+			Result = GetCancelledResult<T>();
+		else
+			Result = Finish(GetProcessResult(std::move(Output), exitStatus));
+	}
+#endif
+};
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+namespace
+{
+#ifdef _WIN32
+	template<typename T, typename F>
+	[[nodiscard]] MD::DialogRequest<T> StartDialogRequest(F&& showDialog)
+	{
+		auto state = std::make_unique<typename MD::DialogRequest<T>::State>();
+		state->Handle = LaunchDialogHandle<T>(std::forward<F>(showDialog));
+
+		return MD::DialogRequest<T>(std::move(state));
+	}
+#else
+	template<typename T>
+	[[nodiscard]] MD::DialogRequest<T> StartDialogRequest(PreparedDialog<T> request)
+	{
+		auto state = std::make_unique<typename MD::DialogRequest<T>::State>();
+
+		if(T* const result = std::get_if<T>(&request))
+		{
+			state->Result = std::move(*result);
+			return MD::DialogRequest<T>(std::move(state));
+		}
+
+		PendingDialog<T>& dialog = std::get<PendingDialog<T>>(request);
+
+		state->Process = SpawnOnProcessReactor(dialog.DialogCommand, state->Control, dialog.BackendName, dialog.Runner);
+		if(!state->Process)
+		{
+			state->Result = dialog.Finish(std::nullopt);
+			return MD::DialogRequest<T>(std::move(state));
+		}
+
+		const int32_t fd = state->Process->OutputFd;
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		state->Finish = std::move(dialog.Finish);
+		state->Deadline = GetDialogDeadline();
+
+		return MD::DialogRequest<T>(std::move(state));
+	}
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetDetectionCacheEnabled([[maybe_unused]] const bool enabled)
+{
+#ifndef _WIN32
+	DetectionCacheEnabled = enabled;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::Prewarm()
+{
+#ifndef _WIN32
+	const std::lock_guard lock(PrewarmMutex);
+	if(!PrewarmFuture.valid())
+		PrewarmFuture = std::async(std::launch::async, []{ static_cast<void>(GetBackendInfo()); }).share();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::WaitForPrewarm()
+{
+#ifndef _WIN32
+	std::shared_future<void> prewarm{};
+	{
+		const std::lock_guard lock(PrewarmMutex);
+		prewarm = PrewarmFuture;
+	}
+
+	if(prewarm.valid())
+		prewarm.wait();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::FilterSet::FilterSet(const std::vector<std::pair<std::string, std::string>>& filterPatterns, const bool allFiles)
+{
+	const std::shared_ptr<Data> data = std::make_shared<Data>();
+	data->AllFiles = allFiles;
+	data->Filters.reserve(filterPatterns.size());
+
+	for(const auto& [name, extensions] : filterPatterns)
+	{
+		//Drop empty patterns, so every filter ends up with at least one
+		std::string patterns{};
+		patterns.reserve(extensions.size());
+		std::size_t begin = 0;
+		while(begin <= extensions.size())
+		{
+			std::size_t end = extensions.find(';', begin);
+			if(end == std::string::npos)
+				end = extensions.size();
+
+			if(end != begin)
+			{
+				if(!patterns.empty())
+					patterns += ';';
+				MD::Detail::AppendSanitizedUTF8(patterns, std::string_view(extensions).substr(begin, end - begin));
+			}
+
+			begin = end + 1;
+		}
+
+		if(patterns.empty())
+			continue;
+
+		std::string filterName{};
+		MD::Detail::AppendSanitizedUTF8(filterName, name);
+
+		data->TextSize += filterName.size() + patterns.size();
+		data->Filters.emplace_back(std::move(filterName), std::move(patterns));
+	}
+
+	//Views are only taken once Filters doesn't reallocate anymore
+	data->Patterns.reserve(data->Filters.size());
+	for(const auto& [name, patterns] : data->Filters)
+	{
+		std::vector<std::string_view>& views = data->Patterns.emplace_back();
+		const std::string_view remaining = patterns;
+		std::size_t begin = 0;
+		while(begin <= remaining.size())
+		{
+			std::size_t end = remaining.find(';', begin);
+			if(end == std::string_view::npos)
+				end = remaining.size();
+
+			views.push_back(remaining.substr(begin, end - begin));
+			begin = end + 1;
+		}
+
+		data->PatternCount += views.size();
+	}
+
+	m_data = data;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::size_t MD::FilterSet::size() const noexcept
+{
+	return m_data->Filters.size();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+bool MD::FilterSet::empty() const noexcept
+{
+	return m_data->Filters.empty();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+const MD::FilterSet::Data& MD::FilterSet::GetData() const noexcept
+{
+	return *m_data;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::string MD::SaveFile(const std::string& title,
+                          const std::string& defaultPathAndFile,
+                          const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                          const bool allFiles)
+{
+	return SaveFile(title, defaultPathAndFile, FilterSet(filterPatterns, allFiles));
+}
+
+std::string MD::SaveFile(const std::string& title, const std::string& defaultPathAndFile, const FilterSet& filters)
+{
+#ifdef _WIN32
+	return ValidateSaveFilePath(SaveFileWinGUI(title, defaultPathAndFile, filters.GetData().Filters, filters.GetData().AllFiles));
+#else
+	return RunDialog(PrepareSaveFile(title, defaultPathAndFile, filters));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::vector<std::string> MD::OpenFile(const std::string& title,
+                                       const std::string& defaultPathAndFile,
+                                       const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                       const bool allowMultipleSelects,
+                                       const bool allFiles)
+{
+	return OpenFile(title, defaultPathAndFile, FilterSet(filterPatterns, allFiles), allowMultipleSelects);
+}
+
+std::vector<std::string> MD::OpenFile(const std::string& title,
+                                       const std::string& defaultPathAndFile,
+                                       const FilterSet& filters,
+                                       const bool allowMultipleSelects)
+{
+#ifdef _WIN32
+	return RetainPathsOfType(OpenFileWinGUI(title, defaultPathAndFile, filters.GetData().Filters, allowMultipleSelects, filters.GetData().AllFiles), PathType::File);
+#else
+	return RunDialog(PrepareOpenFile(title, defaultPathAndFile, filters, allowMultipleSelects));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::PathList::PathList(const std::vector<std::string>& paths)
+{
+	std::size_t bufferSize = 0;
+	for(const std::string& path : paths)
+		bufferSize += path.size() + 1;
+
+	const std::shared_ptr<char[]> buffer(new char[bufferSize]);
+	m_paths.reserve(paths.size());
+
+	char* pathBegin = buffer.get();
+	for(const std::string& path : paths)
+	{
+		std::memcpy(pathBegin, path.c_str(), path.size() + 1);
+		m_paths.emplace_back(pathBegin, path.size());
+		pathBegin += path.size() + 1;
+	}
+
+	m_buffer = buffer;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::PathList::PathList(std::shared_ptr<const char[]> buffer, std::vector<std::string_view> paths)
+	: m_buffer(std::move(buffer)), m_paths(std::move(paths))
+{
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::size_t MD::PathList::size() const noexcept
+{
+	return m_paths.size();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+bool MD::PathList::empty() const noexcept
+{
+	return m_paths.empty();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::string_view MD::PathList::operator[](const std::size_t index) const noexcept
+{
+	return m_paths[index];
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::PathList::const_iterator MD::PathList::begin() const noexcept
+{
+	return m_paths.begin();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::PathList::const_iterator MD::PathList::end() const noexcept
+{
+	return m_paths.end();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::vector<std::string> MD::PathList::ToVector() const
+{
+	return std::vector<std::string>(m_paths.begin(), m_paths.end());
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::PathList MD::OpenFileList(const std::string& title,
+                              const std::string& defaultPathAndFile,
+                              const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                              const bool allowMultipleSelects,
+                              const bool allFiles)
+{
+	return OpenFileList(title, defaultPathAndFile, FilterSet(filterPatterns, allFiles), allowMultipleSelects);
+}
+
+MD::PathList MD::OpenFileList(const std::string& title,
+                              const std::string& defaultPathAndFile,
+                              const FilterSet& filters,
+                              const bool allowMultipleSelects)
+{
+#ifdef _WIN32
+	return PathList(OpenFile(title, defaultPathAndFile, filters, allowMultipleSelects));
+#else
+	return RunDialog(PrepareOpenFileList(title, defaultPathAndFile, filters, allowMultipleSelects));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::string MD::OpenSingleFile(const std::string& title,
+                           const std::string& defaultPathAndFile,
+                           const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                           const bool allFiles)
+{
+	const std::vector<std::string> path = MD::OpenFile(title, defaultPathAndFile, filterPatterns, false, allFiles);
+	return path.empty() ? std::string() : path[0];
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::vector<std::string> MD::OpenMultipleFiles(const std::string& title,
+                              const std::string& defaultPathAndFile,
+                              const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                              const bool allFiles)
+{
+	const std::vector<std::string> paths = MD::OpenFile(title, defaultPathAndFile, filterPatterns, true, allFiles);
+	return paths.empty() ? std::vector<std::string>() : paths;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::string MD::SelectFolder(const std::string& title, const std::string& defaultPath)
+{
+#ifdef _WIN32
+	return SelectFolderWinGUI(title, defaultPath);
+#else
+	return RunDialog(PrepareSelectFolder(title, defaultPath));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::Selection MD::ShowMsgBox(const std::string& title,
+							   const std::string& message,
+							   const MD::Style style,
+							   const MD::Buttons buttons)
+{
+#ifdef _WIN32
+	return ShowMsgBoxWinGUI(title, message, style, buttons);
+#else
+	//The thread finishing the shared dialog can't wait for it itself
+	if(MsgBoxCoalescingEnabled && !IsProcessReactorThread)
+		return ShowCoalescedMsgBox(title, message, style, buttons);
+
+	return RunDialog(PrepareShowMsgBox(title, message, style, buttons));
+#endif
+}
+
+MD::Selection MD::ShowMsgBox(const std::string& title, const std::string& message, const MD::Style style)
+{
+	return ShowMsgBox(title, message, style, MD::Buttons::OK);
+}
+
+MD::Selection MD::ShowMsgBox(const std::string& title, const std::string& message, const MD::Buttons buttons)
+{
+	return ShowMsgBox(title, message, MD::Style::Info, buttons);
+}
+
+MD::Selection MD::ShowMsgBox(const std::string& title, const std::string& message)
+{
+	return ShowMsgBox(title, message, MD::Style::Info, MD::Buttons::OK);
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+struct MD::SaveFileDialog::State : ReusableDialog<std::string>
+{
+	using ReusableDialog::ReusableDialog;
+};
+
+MD::SaveFileDialog::SaveFileDialog(const std::string& title,
+                                   const std::string& defaultPathAndFile,
+                                   const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                   const bool allFiles)
+	: SaveFileDialog(title, defaultPathAndFile, FilterSet(filterPatterns, allFiles))
+{
+}
+
+MD::SaveFileDialog::SaveFileDialog(const std::string& title, const std::string& defaultPathAndFile, const FilterSet& filters)
+#ifdef _WIN32
+	: m_state(std::make_shared<const State>([=]{ return SaveFile(title, defaultPathAndFile, filters); }))
+#else
+	: m_state(std::make_shared<const State>(BackendCapability::SaveFile, [=]{ return PrepareSaveFile(title, defaultPathAndFile, filters); }))
+#endif
+{
+}
+
+std::string MD::SaveFileDialog::Show() const
+{
+	return m_state->Show();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+struct MD::OpenFileDialog::State : ReusableDialog<std::vector<std::string>>
+{
+	using ReusableDialog::ReusableDialog;
+};
+
+MD::OpenFileDialog::OpenFileDialog(const std::string& title,
+                                   const std::string& defaultPathAndFile,
+                                   const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                   const bool allowMultipleSelects,
+                                   const bool allFiles)
+	: OpenFileDialog(title, defaultPathAndFile, FilterSet(filterPatterns, allFiles), allowMultipleSelects)
+{
+}
+
+MD::OpenFileDialog::OpenFileDialog(const std::string& title,
+                                   const std::string& defaultPathAndFile,
+                                   const FilterSet& filters,
+                                   const bool allowMultipleSelects)
+#ifdef _WIN32
+	: m_state(std::make_shared<const State>([=]{ return OpenFile(title, defaultPathAndFile, filters, allowMultipleSelects); }))
+#else
+	: m_state(std::make_shared<const State>(BackendCapability::OpenFile,
+	                                        [=]{ return PrepareOpenFile(title, defaultPathAndFile, filters, allowMultipleSelects); }))
+#endif
+{
+}
+
+std::vector<std::string> MD::OpenFileDialog::Show() const
+{
+	return m_state->Show();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+struct MD::FolderDialog::State : ReusableDialog<std::string>
+{
+	using ReusableDialog::ReusableDialog;
+};
+
+MD::FolderDialog::FolderDialog(const std::string& title, const std::string& defaultPath)
+#ifdef _WIN32
+	: m_state(std::make_shared<const State>([=]{ return SelectFolder(title, defaultPath); }))
+#else
+	: m_state(std::make_shared<const State>(BackendCapability::SelectFolder, [=]{ return PrepareSelectFolder(title, defaultPath); }))
+#endif
+{
+}
+
+std::string MD::FolderDialog::Show() const
+{
+	return m_state->Show();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+struct MD::MsgBox::State : ReusableDialog<MD::Selection>
+{
+	using ReusableDialog::ReusableDialog;
+};
+
+MD::MsgBox::MsgBox(const std::string& title, const std::string& message, const MD::Style style, const MD::Buttons buttons)
+#ifdef _WIN32
+	: m_state(std::make_shared<const State>([=]{ return ShowMsgBox(title, message, style, buttons); }))
+#else
+	: m_state(std::make_shared<const State>(BackendCapability::MsgBox, [=]{ return PrepareShowMsgBox(title, message, style, buttons); }))
+#endif
+{
+}
+
+MD::Selection MD::MsgBox::Show() const
+{
+	return m_state->Show();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetCompletionExecutor(CompletionExecutor executor)
+{
+	const std::lock_guard lock(CompletionExecutorMutex);
+	DialogCompletionExecutor = std::move(executor);
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::future<std::string> MD::SaveFileAsync(const std::string& title,
+                                            const std::string& defaultPathAndFile,
+                                            const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                            const bool allFiles)
+{
+#ifdef _WIN32
+	return LaunchDialogFuture<std::string>([=]{ return SaveFile(title, defaultPathAndFile, filterPatterns, allFiles); });
+#else
+	return LaunchDialogFuture(PrepareSaveFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles)));
+#endif
+}
+
+void MD::SaveFileAsync(std::function<void(std::string)> callback,
+                       const std::string& title,
+                       const std::string& defaultPathAndFile,
+                       const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                       const bool allFiles)
+{
+#ifdef _WIN32
+	LaunchDialogCallback(std::move(callback), [=]{ return SaveFile(title, defaultPathAndFile, filterPatterns, allFiles); });
+#else
+	LaunchDialogCallback(std::move(callback), PrepareSaveFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles)));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::future<std::vector<std::string>> MD::OpenFileAsync(const std::string& title,
+                                                         const std::string& defaultPathAndFile,
+                                                         const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                                         const bool allowMultipleSelects,
+                                                         const bool allFiles)
+{
+#ifdef _WIN32
+	return LaunchDialogFuture<std::vector<std::string>>([=]{ return OpenFile(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles); });
+#else
+	return LaunchDialogFuture(PrepareOpenFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles), allowMultipleSelects));
+#endif
+}
+
+void MD::OpenFileAsync(std::function<void(std::vector<std::string>)> callback,
+                       const std::string& title,
+                       const std::string& defaultPathAndFile,
+                       const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                       const bool allowMultipleSelects,
+                       const bool allFiles)
+{
+#ifdef _WIN32
+	LaunchDialogCallback(std::move(callback), [=]{ return OpenFile(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles); });
+#else
+	LaunchDialogCallback(std::move(callback), PrepareOpenFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles), allowMultipleSelects));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::future<std::string> MD::SelectFolderAsync(const std::string& title, const std::string& defaultPath)
+{
+#ifdef _WIN32
+	return LaunchDialogFuture<std::string>([=]{ return SelectFolder(title, defaultPath); });
+#else
+	return LaunchDialogFuture(PrepareSelectFolder(title, defaultPath));
+#endif
+}
+
+void MD::SelectFolderAsync(std::function<void(std::string)> callback, const std::string& title, const std::string& defaultPath)
+{
+#ifdef _WIN32
+	LaunchDialogCallback(std::move(callback), [=]{ return SelectFolder(title, defaultPath); });
+#else
+	LaunchDialogCallback(std::move(callback), PrepareSelectFolder(title, defaultPath));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::future<MD::Selection> MD::ShowMsgBoxAsync(const std::string& title,
+                                                 const std::string& message,
+                                                 const MD::Style style,
+                                                 const MD::Buttons buttons)
+{
+#ifdef _WIN32
+	return LaunchDialogFuture<MD::Selection>([=]{ return ShowMsgBox(title, message, style, buttons); });
+#else
+	if(MsgBoxCoalescingEnabled)
+	{
+		auto promise = std::make_shared<std::promise<MD::Selection>>();
+		std::future<MD::Selection> future = promise->get_future();
+		LaunchCoalescedMsgBox(title, message, style, buttons, [promise](const MD::Selection selection){ promise->set_value(selection); });
+
+		return future;
+	}
+
+	return LaunchDialogFuture(PrepareShowMsgBox(title, message, style, buttons));
+#endif
+}
+
+void MD::ShowMsgBoxAsync(std::function<void(Selection)> callback,
+                         const std::string& title,
+                         const std::string& message,
+                         const MD::Style style,
+                         const MD::Buttons buttons)
+{
+#ifdef _WIN32
+	LaunchDialogCallback(std::move(callback), [=]{ return ShowMsgBox(title, message, style, buttons); });
+#else
+	if(MsgBoxCoalescingEnabled)
+	{
+		LaunchCoalescedMsgBox(title, message, style, buttons, [callback = std::move(callback)](const MD::Selection selection){ DeliverResult(callback, selection); });
+		return;
+	}
+
+	LaunchDialogCallback(std::move(callback), PrepareShowMsgBox(title, message, style, buttons));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetDialogTimeout([[maybe_unused]] const std::chrono::milliseconds timeout)
+{
+#ifndef _WIN32
+	DialogTimeoutMilliseconds = timeout.count();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetPathValidationTimeout(const std::chrono::milliseconds timeout)
+{
+	PathValidationTimeoutMilliseconds = timeout.count();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetTraceSink([[maybe_unused]] TraceSink sink)
+{
+#ifndef MD_DISABLE_TRACING
+	const bool enabled = static_cast<bool>(sink);
+
+	{
+		const std::lock_guard lock(TraceSinkMutex);
+		DialogTraceSink = std::move(sink);
+	}
+
+	TracingEnabled = enabled;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetMaxDialogOutputSize([[maybe_unused]] const std::size_t bytes)
+{
+#ifndef _WIN32
+	MaxProcessOutputSize = bytes;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetTKinterHelperEnabled([[maybe_unused]] const bool enabled)
+{
+#ifndef _WIN32
+	TKinterHelperEnabled = enabled;
+
+	TKinterHelper& helper = GetTKinterHelper();
+	{
+		const std::lock_guard lock(helper.Mutex);
+		//Nothing to stop if the helper never ran
+		if(!enabled && !helper.Thread.joinable())
+			return;
+
+		helper.PrestartPending = enabled;
+		StartTKinterHelperThread(helper);
+	}
+	helper.Changed.notify_all();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetParentWindow(const uint64_t window)
+{
+	ParentWindow = window;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetGTKBackendEnabled([[maybe_unused]] const bool enabled)
+{
+#ifndef _WIN32
+	GTKBackendEnabled = enabled;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetPathNormalizationEnabled([[maybe_unused]] const bool enabled)
+{
+#ifndef _WIN32
+	PathNormalizationEnabled = enabled;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetMaxConcurrentDialogs([[maybe_unused]] const std::size_t count)
+{
+#ifndef _WIN32
+	Scheduler.SetMaxConcurrent(count);
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::SetMsgBoxCoalescingEnabled([[maybe_unused]] const bool enabled)
+{
+#ifndef _WIN32
+	MsgBoxCoalescingEnabled = enabled;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+MD::DialogHandle<T>::DialogHandle(std::shared_ptr<State> state)
+	: m_state(std::move(state))
+{
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+bool MD::DialogHandle<T>::Valid() const
+{
+	return m_state != nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+bool MD::DialogHandle<T>::IsDone() const
+{
+	if(!m_state)
+		return true;
+
+	const std::lock_guard lock(m_state->Mutex);
+	return m_state->Result.has_value();
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+void MD::DialogHandle<T>::Cancel()
+{
+	if(!m_state)
+		return;
+
+#ifdef _WIN32
+	m_state->SetResult(GetCancelledResult<T>());
+#else
+	CancelDialog(*m_state->Control);
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+void MD::DialogHandle<T>::Wait() const
+{
+	if(!m_state)
+		return;
+
+	std::unique_lock lock(m_state->Mutex);
+	m_state->Finished.wait(lock, [this](){ return m_state->Result.has_value(); });
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+bool MD::DialogHandle<T>::WaitFor(const std::chrono::milliseconds timeout) const
+{
+	if(!m_state)
+		return true;
+
+	std::unique_lock lock(m_state->Mutex);
+	return m_state->Finished.wait_for(lock, timeout, [this](){ return m_state->Result.has_value(); });
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+T MD::DialogHandle<T>::Get() const
+{
+	if(!m_state)
+		return GetCancelledResult<T>();
+
+	Wait();
+
+	const std::lock_guard lock(m_state->Mutex);
+	return *m_state->Result;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template class MD::DialogHandle<std::string>;
+template class MD::DialogHandle<std::vector<std::string>>;
+template class MD::DialogHandle<MD::Selection>;
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::DialogHandle<std::string> MD::LaunchSaveFile(const std::string& title,
+                                                  const std::string& defaultPathAndFile,
+                                                  const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                                  const bool allFiles)
+{
+#ifdef _WIN32
+	return LaunchDialogHandle<std::string>([=]{ return SaveFile(title, defaultPathAndFile, filterPatterns, allFiles); });
+#else
+	return LaunchDialogHandle(PrepareSaveFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles)));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::DialogHandle<std::vector<std::string>> MD::LaunchOpenFile(const std::string& title,
+                                                               const std::string& defaultPathAndFile,
+                                                               const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                                               const bool allowMultipleSelects,
+                                                               const bool allFiles)
+{
+#ifdef _WIN32
+	return LaunchDialogHandle<std::vector<std::string>>([=]{ return OpenFile(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles); });
+#else
+	return LaunchDialogHandle(PrepareOpenFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles), allowMultipleSelects));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::DialogHandle<std::string> MD::LaunchSelectFolder(const std::string& title, const std::string& defaultPath)
+{
+#ifdef _WIN32
+	return LaunchDialogHandle<std::string>([=]{ return SelectFolder(title, defaultPath); });
+#else
+	return LaunchDialogHandle(PrepareSelectFolder(title, defaultPath));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::DialogHandle<MD::Selection> MD::LaunchMsgBox(const std::string& title,
+                                                  const std::string& message,
+                                                  const MD::Style style,
+                                                  const MD::Buttons buttons)
+{
+#ifdef _WIN32
+	return LaunchDialogHandle<MD::Selection>([=]{ return ShowMsgBox(title, message, style, buttons); });
 #else
-	std::string dialogString{};
-	if(KDialogPresent())
-		dialogString = GetKDialogSaveFileCommand(title, defaultPathAndFile, filterPatterns, allFiles);
-	else if(ZenityPresent())
-		dialogString = GetZenitySaveFileCommand(title, defaultPathAndFile, filterPatterns, allFiles);
-	else if(MateDialogPresent())
-		dialogString = GetMateDialogSaveFileCommand(title, defaultPathAndFile, filterPatterns, allFiles);
-	else if(ShellementaryPresent())
-		dialogString = GetShellementarySaveFileCommand(title, defaultPathAndFile, filterPatterns, allFiles);
-	else if(QarmaPresent())
-		dialogString = GetQarmaSaveFileCommand(title, defaultPathAndFile, filterPatterns, allFiles);
-	else if(YadPresent())
-		dialogString = GetYadSaveFileCommand(title, defaultPathAndFile, filterPatterns, allFiles);
-	else if(TKinter3Present())
-		dialogString = GetTKinter3SaveFileCommand(title, defaultPathAndFile, filterPatterns, allFiles);
+	return LaunchDialogHandle(PrepareShowMsgBox(title, message, style, buttons));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+MD::DialogRequest<T>::DialogRequest() = default;
+
+template<typename T>
+MD::DialogRequest<T>::DialogRequest(std::unique_ptr<State> state)
+	: m_state(std::move(state))
+{
+}
+
+template<typename T>
+MD::DialogRequest<T>::~DialogRequest() = default;
+
+template<typename T>
+MD::DialogRequest<T>::DialogRequest(DialogRequest&&) noexcept = default;
 
-	FILE* in = popen(dialogString.data(), "r");
-	if(in == nullptr)
-		return "";
+template<typename T>
+MD::DialogRequest<T>& MD::DialogRequest<T>::operator=(DialogRequest&&) noexcept = default;
 
-	std::array<char, 128> buffer{};
-	while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-		path += buffer.data();
-	pclose(in);
+//-------------------------------------------------------------------------------------------------------------------//
+
+template<typename T>
+int MD::DialogRequest<T>::GetFd() const
+{
+#ifdef _WIN32
+	return -1;
+#else
+	if(!m_state || !m_state->Process)
+		return -1;
 
-	if (!path.empty() && path.back() == '\n')
-		path.pop_back();
+	return m_state->Process->OutputFd;
 #endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
 
-	if (path.empty())
-		return "";
-	std::string str = GetPathWithoutFinalSlash(path);
-	if (str.empty() || !DirExists(str))
-		return "";
-	str = GetLastName(path);
-	if (!FilenameValid(str))
-		return "";
+template<typename T>
+int32_t MD::DialogRequest<T>::GetTimeout() const
+{
+#ifdef _WIN32
+	return -1;
+#else
+	if(!m_state || !m_state->Process)
+		return -1;
 
-	return path;
+	return GetPollTimeout(m_state->Deadline);
+#endif
 }
 
 //-------------------------------------------------------------------------------------------------------------------//
 
-std::vector<std::string> MD::OpenFile(const std::string& title,
-                                       const std::string& defaultPathAndFile,
-                                       const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-                                       const bool allowMultipleSelects,
-                                       const bool allFiles)
+template<typename T>
+bool MD::DialogRequest<T>::OnReadable()
 {
-	if (QuoteDetected(title))
-		return OpenFile("INVALID TITLE WITH QUOTES", defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	if (QuoteDetected(defaultPathAndFile))
-		return OpenFile(title, "INVALID DEFAULT_PATH WITH QUOTES", filterPatterns, allowMultipleSelects, allFiles);
-	for(const auto& [fst, snd] : filterPatterns)
-	{
-		if (QuoteDetected(fst) || QuoteDetected(snd))
-			return OpenFile("INVALID FILTER_PATTERN WITH QUOTES", defaultPathAndFile, {}, allowMultipleSelects, allFiles);
-	}
+	if(!m_state)
+		return false;
+	if(m_state->Result)
+		return true;
 
-	std::vector<std::string> paths{};
 #ifdef _WIN32
-	paths = OpenFileWinGUI(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
+	if(!m_state->Handle.IsDone())
+		return false;
+
+	m_state->Result = m_state->Handle.Get();
+	return true;
 #else
-	std::string dialogString{};
-	bool wasKDialog = false;
-	if(KDialogPresent())
-	{
-		wasKDialog = true;
-		dialogString = GetKDialogOpenFileCommand(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	}
-	else if(ZenityPresent())
-		dialogString = GetZenityOpenFileCommand(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	else if(MateDialogPresent())
-		dialogString = GetMateDialogOpenFileCommand(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	else if(ShellementaryPresent())
-		dialogString = GetShellementaryOpenFileCommand(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	else if(QarmaPresent())
-		dialogString = GetQarmaOpenFileCommand(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	else if(YadPresent())
-		dialogString = GetYadOpenFileCommand(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-	else if(TKinter3Present())
-		dialogString = GetTKinter3OpenFileCommand(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles);
-
-	FILE* in = popen(dialogString.data(), "r");
-	if(in == nullptr)
-		return {};
-
-	std::array<char, 128> buffer{};
-	std::string tmp{};
-	while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-		tmp += buffer.data();
-
-	pclose(in);
-
-	if(!tmp.empty() && tmp.back() == '\n')
-		tmp.pop_back();
-
-	char separator = '|';
-	if(wasKDialog)
-		separator = '\n';
-
-	if(!tmp.empty())
+	if(m_state->Deadline <= std::chrono::steady_clock::now())
 	{
-		if(allowMultipleSelects)
+		//The process exits right away, its pipe becomes readable then
+		TerminateDialogProcess(m_state->Control);
+		m_state->Deadline = std::chrono::steady_clock::time_point::max();
+	}
+
+	while(true)
+	{
+		switch(ReadProcessOutput(m_state->Process->OutputFd, m_state->Output))
 		{
-			tmp += separator;
-			std::size_t pos = 0;
-			while((pos = tmp.find(separator)) != std::string::npos)
-			{
-				std::string token = tmp.substr(0, pos);
-				paths.push_back(std::move(token));
-				tmp.erase(0, pos + 1);
-			}
+		case ReadStatus::Data:
+			continue;
+
+		case ReadStatus::WouldBlock:
+			return false;
+
+		case ReadStatus::EndOfFile:
+			m_state->Complete();
+			return true;
 		}
-		else
-			paths.push_back(tmp);
 	}
 #endif
+}
 
-	if (paths.empty())
-		return {};
-	for(auto it = paths.begin(); it != paths.end();)
-	{
-		if(!FileExists(*it))
-			it = paths.erase(it);
-		else
-			++it;
-	}
+//-------------------------------------------------------------------------------------------------------------------//
 
-	return paths;
+template<typename T>
+std::optional<T> MD::DialogRequest<T>::TryGetResult()
+{
+	if(!OnReadable())
+		return std::nullopt;
+
+	return m_state->Result;
 }
 
 //-------------------------------------------------------------------------------------------------------------------//
 
-std::string MD::OpenSingleFile(const std::string& title,
-                           const std::string& defaultPathAndFile,
-                           const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-                           const bool allFiles)
+template<typename T>
+void MD::DialogRequest<T>::Cancel()
 {
-	const std::vector<std::string> path = MD::OpenFile(title, defaultPathAndFile, filterPatterns, false, allFiles);
-	return path.empty() ? std::string() : path[0];
+	if(!m_state || m_state->Result)
+		return;
+
+#ifdef _WIN32
+	m_state->Handle.Cancel();
+#else
+	TerminateDialogProcess(m_state->Control);
+#endif
 }
 
 //-------------------------------------------------------------------------------------------------------------------//
 
-std::vector<std::string> MD::OpenMultipleFiles(const std::string& title,
-                              const std::string& defaultPathAndFile,
-                              const std::vector<std::pair<std::string, std::string>>& filterPatterns,
-                              const bool allFiles)
+template class MD::DialogRequest<std::string>;
+template class MD::DialogRequest<std::vector<std::string>>;
+template class MD::DialogRequest<MD::Selection>;
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::DialogRequest<std::string> MD::RequestSaveFile(const std::string& title,
+                                                    const std::string& defaultPathAndFile,
+                                                    const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                                    const bool allFiles)
 {
-	const std::vector<std::string> paths = MD::OpenFile(title, defaultPathAndFile, filterPatterns, true, allFiles);
-	return paths.empty() ? std::vector<std::string>() : paths;
+#ifdef _WIN32
+	return StartDialogRequest<std::string>([=]{ return SaveFile(title, defaultPathAndFile, filterPatterns, allFiles); });
+#else
+	return StartDialogRequest(PrepareSaveFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles)));
+#endif
 }
 
 //-------------------------------------------------------------------------------------------------------------------//
 
-std::string MD::SelectFolder(const std::string& title, const std::string& defaultPath)
+MD::DialogRequest<std::vector<std::string>> MD::RequestOpenFile(const std::string& title,
+                                                                 const std::string& defaultPathAndFile,
+                                                                 const std::vector<std::pair<std::string, std::string>>& filterPatterns,
+                                                                 const bool allowMultipleSelects,
+                                                                 const bool allFiles)
 {
-	if (QuoteDetected(title))
-		return MD::SelectFolder("INVALID TITLE WITH QUOTES", defaultPath);
-	if (QuoteDetected(defaultPath))
-		return MD::SelectFolder(title, "INVALID DEFAULT_PATH WITH QUOTES");
+#ifdef _WIN32
+	return StartDialogRequest<std::vector<std::string>>([=]{ return OpenFile(title, defaultPathAndFile, filterPatterns, allowMultipleSelects, allFiles); });
+#else
+	return StartDialogRequest(PrepareOpenFile(title, defaultPathAndFile, MD::FilterSet(filterPatterns, allFiles), allowMultipleSelects));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::DialogRequest<std::string> MD::RequestSelectFolder(const std::string& title, const std::string& defaultPath)
+{
+#ifdef _WIN32
+	return StartDialogRequest<std::string>([=]{ return SelectFolder(title, defaultPath); });
+#else
+	return StartDialogRequest(PrepareSelectFolder(title, defaultPath));
+#endif
+}
 
-	std::string path{};
+//-------------------------------------------------------------------------------------------------------------------//
+
+MD::DialogRequest<MD::Selection> MD::RequestMsgBox(const std::string& title,
+                                                    const std::string& message,
+                                                    const MD::Style style,
+                                                    const MD::Buttons buttons)
+{
 #ifdef _WIN32
-	path = SelectFolderWinGUI(title, defaultPath);
+	return StartDialogRequest<MD::Selection>([=]{ return ShowMsgBox(title, message, style, buttons); });
 #else
-	std::string dialogString;
-	if(KDialogPresent())
-		dialogString = GetKDialogSelectFolderCommand(title, defaultPath);
-	else if(ZenityPresent())
-		dialogString = GetZenitySelectFolderCommand(title, defaultPath);
-	else if(MateDialogPresent())
-		dialogString = GetMateDialogSelectFolderCommand(title, defaultPath);
-	else if(ShellementaryPresent())
-		dialogString = GetShellementarySelectFolderCommand(title, defaultPath);
-	else if(QarmaPresent())
-		dialogString = GetQarmaSelectFolderCommand(title, defaultPath);
-	else if(YadPresent())
-		dialogString = GetYadSelectFolderCommand(title, defaultPath);
-	else if(TKinter3Present())
-		dialogString = GetTKinter3SelectFolderCommand(title, defaultPath);
+	return StartDialogRequest(PrepareShowMsgBox(title, message, style, buttons));
+#endif
+}
 
-	FILE* in = popen(dialogString.data(), "r");
-	if(in == nullptr)
-		return "";
+//-------------------------------------------------------------------------------------------------------------------//
 
-	std::array<char, 128> buffer{};
-	while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-		path += buffer.data();
+std::size_t MD::Detail::ResolveExecutables()
+{
+#ifdef _WIN32
+	return 0;
+#else
+	const ExecutablePaths paths = ::ResolveExecutables();
 
-	if(!path.empty() && path.back() == '\n')
-		path.pop_back();
+	std::size_t found = 0;
+	for(const std::string* const path : {&paths.XProp, &paths.Zenity, &paths.MateDialog, &paths.Shellementary,
+	                                     &paths.Qarma, &paths.Yad, &paths.KDialog, &paths.Python3})
+	{
+		if(!path->empty())
+			++found;
+	}
 
-	if(!DirExists(path))
-		return "";
+	return found;
 #endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::vector<std::string_view> MD::Detail::SplitPaths(const std::string_view output, const char separator)
+{
+	const char* const begin = output.data();
+	const char* const end = begin + output.size();
+
+	//Count first, so the result is allocated exactly once
+	std::size_t separatorCount = 0;
+	for(const char* it = begin; it < end; ++separatorCount)
+	{
+		const void* const next = std::memchr(it, separator, static_cast<std::size_t>(end - it));
+		if(next == nullptr)
+			break;
+		it = static_cast<const char*>(next) + 1;
+	}
 
-	if (path.empty())
-		return "";
+	std::vector<std::string_view> paths{};
+	paths.reserve(separatorCount + 1);
 
-	return path;
+	const char* pathBegin = begin;
+	while(pathBegin < end)
+	{
+		const void* const next = std::memchr(pathBegin, separator, static_cast<std::size_t>(end - pathBegin));
+		const char* const pathEnd = next != nullptr ? static_cast<const char*>(next) : end;
+
+		if(pathEnd != pathBegin)
+			paths.emplace_back(pathBegin, static_cast<std::size_t>(pathEnd - pathBegin));
+
+		pathBegin = pathEnd + 1;
+	}
+
+	return paths;
 }
 
 //-------------------------------------------------------------------------------------------------------------------//
 
-MD::Selection MD::ShowMsgBox(const std::string& title,
-							   const std::string& message,
-							   const MD::Style style,
-							   const MD::Buttons buttons)
+namespace
 {
-	MD::Selection selection = MD::Selection::Error;
+	constexpr std::string_view PythonSpecialCharacters{"\\'\n\r\0", 5};
+	constexpr std::string_view MarkupSpecialCharacters{"&<>"};
 
-	if (QuoteDetected(title))
-		return MD::ShowMsgBox("INVALID TITLE WITH QUOTES", message, style, buttons);
-	if (QuoteDetected(message))
-		return MD::ShowMsgBox(title, "INVALID DEFAULT_PATH WITH QUOTES", style, buttons);
+	//-------------------------------------------------------------------------------------------------------------------//
 
-#ifdef _WIN32
-	selection = ShowMsgBoxWinGUI(title, message, style, buttons);
+#if defined(MD_SIMD_AVX2) || defined(MD_SIMD_SSE2)
+	/// <summary>
+	/// Index of the lowest set bit of a non-zero mask.
+	/// </summary>
+	[[nodiscard]] uint32_t CountTrailingZeros(const uint32_t mask) noexcept
+	{
+#ifdef _MSC_VER
+		unsigned long index = 0;
+		_BitScanForward(&index, mask);
+		return static_cast<uint32_t>(index);
 #else
-	std::string dialogString;
-	if(KDialogPresent())
-		dialogString = GetKDialogMsgBoxCommand(title, message, style, buttons);
-	else if(ZenityPresent())
-		dialogString = GetZenityMsgBoxCommand(title, message, style, buttons);
-	else if(MateDialogPresent())
-		dialogString = GetMateDialogMsgBoxCommand(title, message, style, buttons);
-	else if(ShellementaryPresent())
-		dialogString = GetShellementaryMsgBoxCommand(title, message, style, buttons);
-	else if(QarmaPresent())
-		dialogString = GetQarmaMsgBoxCommand(title, message, style, buttons);
-	else if(YadPresent())
-		dialogString = GetYadMsgBoxCommand(title, message, style, buttons);
-	else if(TKinter3Present())
-		dialogString = GetTKinter3MsgBoxCommand(title, message, style, buttons);
-	else
-		selection = Selection::None;
-
-	std::array<char, 128> buffer{};
-	std::string tmp{};
-
-	FILE* in = popen(dialogString.data(), "r");
-	if(in == nullptr)
-		return {};
-
-	while(fgets(buffer.data(), buffer.size(), in) != nullptr)
-		tmp += buffer.data();
-
-	if(!tmp.empty() && tmp.back() == '\n')
-		tmp.pop_back();
-
-	if (tmp == "1")
-	{
-		if (buttons == MD::Buttons::YesNo)
-			selection = MD::Selection::Yes;
-		else if (buttons == MD::Buttons::OKCancel)
-			selection = MD::Selection::OK;
-		else if (buttons == MD::Buttons::OK)
-			selection = MD::Selection::OK;
-        else if (buttons == MD::Buttons::Quit)
-            selection = MD::Selection::Quit;
-	}
-	else if (tmp == "0")
-	{
-		if (buttons == MD::Buttons::YesNo)
-			selection = MD::Selection::No;
-		else if (buttons == MD::Buttons::OKCancel)
-			selection = MD::Selection::Cancel;
-		else if (buttons == MD::Buttons::OK)
-			selection = MD::Selection::Quit;
-        else if (buttons == MD::Buttons::Quit)
-            selection = MD::Selection::Quit;
-	}
-#endif
-
-	return selection;
+		return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+	}
+#endif
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Length of the well-formed UTF-8 sequence starting at text[pos], see table 3-7 of the Unicode standard.
+	/// </summary>
+	/// <param name="text">Text to decode.</param>
+	/// <param name="pos">Index of the lead byte.</param>
+	/// <param name="invalidLength">Length of the maximal ill-formed subpart if the sequence is invalid.</param>
+	/// <returns>Length of the sequence or 0 if it is invalid.</returns>
+	[[nodiscard]] std::size_t GetUTF8SequenceLength(const std::string_view text, const std::size_t pos, std::size_t& invalidLength) noexcept
+	{
+		const unsigned char lead = static_cast<unsigned char>(text[pos]);
+
+		std::size_t length = 0;
+		//Range of the second byte, excluding overlong forms, surrogates and code points above U+10FFFF
+		unsigned char low = 0x80u;
+		unsigned char high = 0xBFu;
+		if(lead < 0x80u)
+			return 1;
+		if(lead >= 0xC2u && lead <= 0xDFu)
+			length = 2;
+		else if(lead >= 0xE0u && lead <= 0xEFu)
+		{
+			length = 3;
+			if(lead == 0xE0u)
+				low = 0xA0u;
+			else if(lead == 0xEDu)
+				high = 0x9Fu;
+		}
+		else if(lead >= 0xF0u && lead <= 0xF4u)
+		{
+			length = 4;
+			if(lead == 0xF0u)
+				low = 0x90u;
+			else if(lead == 0xF4u)
+				high = 0x8Fu;
+		}
+		else
+		{
+			invalidLength = 1;
+			return 0;
+		}
+
+		for(std::size_t i = 1; i < length; ++i)
+		{
+			const unsigned char byte = pos + i < text.size() ? static_cast<unsigned char>(text[pos + i]) : 0u;
+			if(byte < (i == 1 ? low : 0x80u) || byte > (i == 1 ? high : 0xBFu))
+			{
+				invalidLength = i;
+				return 0;
+			}
+		}
+
+		return length;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Append text to out, replacing every character of special with what escape appends for it.<br>
+	/// Runs between the special characters are copied in one piece.
+	/// </summary>
+	template<typename F>
+	void AppendEscaped(std::string& out, const std::string_view text, const std::string_view special, F escape)
+	{
+		std::size_t begin = 0;
+		for(std::size_t pos = MD::Detail::FindFirstOf(text, special); pos != std::string_view::npos;
+		    pos = MD::Detail::FindFirstOf(text, special, begin))
+		{
+			out.append(text.data() + begin, pos - begin);
+			escape(out, text[pos]);
+			begin = pos + 1;
+		}
+
+		out.append(text.data() + begin, text.size() - begin);
+	}
 }
 
-MD::Selection MD::ShowMsgBox(const std::string& title, const std::string& message, const MD::Style style)
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::size_t MD::Detail::FindFirstOf(const std::string_view text, const std::string_view characters, std::size_t pos) noexcept
 {
-	return ShowMsgBox(title, message, style, MD::Buttons::OK);
+	const std::size_t size = text.size();
+	if(characters.empty() || pos >= size)
+		return std::string_view::npos;
+
+	const char* const data = text.data();
+
+	//Every block is compared against each character, larger sets are left to the scalar scan
+	constexpr std::size_t MaxVectorCharacters = 16;
+	if(characters.size() <= MaxVectorCharacters)
+	{
+#if defined(MD_SIMD_AVX2)
+		__m256i wideNeedles[MaxVectorCharacters]{};
+		for(std::size_t i = 0; i < characters.size(); ++i)
+			wideNeedles[i] = _mm256_set1_epi8(characters[i]);
+
+		for(; pos + 32 <= size; pos += 32)
+		{
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+			__m256i matches = _mm256_cmpeq_epi8(block, wideNeedles[0]);
+			for(std::size_t i = 1; i < characters.size(); ++i)
+				matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, wideNeedles[i]));
+
+			const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+			if(mask != 0)
+				return pos + CountTrailingZeros(mask);
+		}
+#endif
+
+#if defined(MD_SIMD_AVX2) || defined(MD_SIMD_SSE2)
+		__m128i needles[MaxVectorCharacters]{};
+		for(std::size_t i = 0; i < characters.size(); ++i)
+			needles[i] = _mm_set1_epi8(characters[i]);
+
+		const auto matchBlock = [&needles, count = characters.size()](const char* const block16)
+		{
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block16));
+			__m128i matches = _mm_cmpeq_epi8(block, needles[0]);
+			for(std::size_t i = 1; i < count; ++i)
+				matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, needles[i]));
+
+			return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+		};
+
+		for(; pos + 16 <= size; pos += 16)
+		{
+			const uint32_t mask = matchBlock(data + pos);
+			if(mask != 0)
+				return pos + CountTrailingZeros(mask);
+		}
+
+		if(pos == size)
+			return std::string_view::npos;
+
+		//The tail is copied into a padded block instead of reading past the end of text, the padding is masked out
+		char tail[16]{};
+		std::memcpy(tail, data + pos, size - pos);
+		const uint32_t mask = matchBlock(tail) & ((1u << (size - pos)) - 1u);
+		if(mask != 0)
+			return pos + CountTrailingZeros(mask);
+
+		return std::string_view::npos;
+#elif defined(MD_SIMD_NEON)
+		uint8x16_t needles[MaxVectorCharacters]{};
+		for(std::size_t i = 0; i < characters.size(); ++i)
+			needles[i] = vdupq_n_u8(static_cast<uint8_t>(characters[i]));
+
+		for(; pos + 16 <= size; pos += 16)
+		{
+			const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + pos));
+			uint8x16_t matches = vceqq_u8(block, needles[0]);
+			for(std::size_t i = 1; i < characters.size(); ++i)
+				matches = vorrq_u8(matches, vceqq_u8(block, needles[i]));
+
+			//NEON has no movemask, the scalar scan below locates the match inside the block
+			if(vmaxvq_u8(matches) != 0)
+				break;
+		}
+#endif
+	}
+
+	for(; pos < size; ++pos)
+	{
+		if(std::memchr(characters.data(), data[pos], characters.size()) != nullptr)
+			return pos;
+	}
+
+	return std::string_view::npos;
 }
 
-MD::Selection MD::ShowMsgBox(const std::string& title, const std::string& message, const MD::Buttons buttons)
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::size_t MD::Detail::FindFirstNonASCII(const std::string_view text, std::size_t pos) noexcept
 {
-	return ShowMsgBox(title, message, MD::Style::Info, buttons);
+	const std::size_t size = text.size();
+	if(pos >= size)
+		return std::string_view::npos;
+
+	const char* const data = text.data();
+
+#if defined(MD_SIMD_AVX2)
+	for(; pos + 32 <= size; pos += 32)
+	{
+		const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos))));
+		if(mask != 0)
+			return pos + CountTrailingZeros(mask);
+	}
+#endif
+
+#if defined(MD_SIMD_AVX2) || defined(MD_SIMD_SSE2)
+	//The sign bit of every byte is its non-ASCII bit, movemask collects them directly
+	for(; pos + 16 <= size; pos += 16)
+	{
+		const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos))));
+		if(mask != 0)
+			return pos + CountTrailingZeros(mask);
+	}
+#elif defined(MD_SIMD_NEON)
+	for(; pos + 16 <= size; pos += 16)
+	{
+		if(vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + pos))) >= 0x80u)
+			break;
+	}
+#endif
+
+	for(; pos < size; ++pos)
+	{
+		if(static_cast<unsigned char>(data[pos]) >= 0x80u)
+			return pos;
+	}
+
+	return std::string_view::npos;
 }
 
-MD::Selection MD::ShowMsgBox(const std::string& title, const std::string& message)
+//-------------------------------------------------------------------------------------------------------------------//
+
+std::size_t MD::Detail::FindInvalidUTF8(const std::string_view text, std::size_t pos) noexcept
 {
-	return ShowMsgBox(title, message, MD::Style::Info, MD::Buttons::OK);
+	while((pos = FindFirstNonASCII(text, pos)) != std::string_view::npos)
+	{
+		//Decode up to the next ASCII byte, which lets the vectorised scan take over again
+		while(pos < text.size() && static_cast<unsigned char>(text[pos]) >= 0x80u)
+		{
+			std::size_t invalidLength = 0;
+			const std::size_t length = GetUTF8SequenceLength(text, pos, invalidLength);
+			if(length == 0)
+				return pos;
+
+			pos += length;
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::Detail::AppendSanitizedUTF8(std::string& out, const std::string_view text)
+{
+	std::size_t begin = 0;
+	for(std::size_t pos = FindInvalidUTF8(text); pos != std::string_view::npos; pos = FindInvalidUTF8(text, begin))
+	{
+		std::size_t invalidLength = 1;
+		static_cast<void>(GetUTF8SequenceLength(text, pos, invalidLength));
+
+		out.append(text.data() + begin, pos - begin);
+		out += "\xEF\xBF\xBD";
+		begin = pos + invalidLength;
+	}
+
+	out.append(text.data() + begin, text.size() - begin);
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+bool MD::Detail::NormalizeToNFC([[maybe_unused]] std::string& text)
+{
+	//ASCII is its own normal form
+	if(FindFirstNonASCII(text) == std::string_view::npos)
+		return false;
+
+#ifdef _WIN32
+	return false;
+#else
+	const GLibNormalizer* const glib = GetGLibNormalizer();
+	if(glib == nullptr)
+		return false;
+
+	//Returns nullptr for invalid UTF-8
+	char* const normalized = glib->Normalize(text.data(), static_cast<ssize_t>(text.size()), GLibNormalizeNFC);
+	if(normalized == nullptr)
+		return false;
+
+	const bool changed = text != normalized;
+	if(changed)
+		text = normalized;
+	glib->Free(normalized);
+
+	return changed;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::Detail::AppendPythonEscaped(std::string& out, const std::string_view text)
+{
+	AppendEscaped(out, text, PythonSpecialCharacters, [](std::string& str, const char c)
+	{
+		if(c == '\n')
+			str += "\\n";
+		else if(c == '\r')
+			str += "\\r";
+		else if(c == '\0')
+			str += "\\x00";
+		else
+		{
+			str += '\\';
+			str += c;
+		}
+	});
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+void MD::Detail::AppendMarkupEscaped(std::string& out, const std::string_view text)
+{
+	AppendEscaped(out, text, MarkupSpecialCharacters, [](std::string& str, const char c)
+	{
+		if(c == '&')
+			str += "&amp;";
+		else if(c == '<')
+			str += "&lt;";
+		else
+			str += "&gt;";
+	});
 }
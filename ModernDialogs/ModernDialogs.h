@@ -25,11 +25,83 @@ SOFTWARE.
 #ifndef _GAMESTRAP_MODERNDIALOGS_H_
 #define _GAMESTRAP_MODERNDIALOGS_H_
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace MD
 {
+    /// <summary>
+    /// Enable or disable the persistent backend detection cache (Linux only, disabled by default).<br>
+    /// When enabled, the results of backend probes which need to start a process or call the session bus
+    /// (zenity version, kdialog features, xprop, the Python tkinter import and the FileChooser portal version)
+    /// are stored in "$XDG_CACHE_HOME/ModernDialogs/backends" and reused by later processes.<br>
+    /// Entries are only used while PATH, the display, session bus and desktop environment variables and
+    /// the resolved backend executables are unchanged.<br>
+    /// Call this before the first dialog is opened.
+    /// </summary>
+    /// <param name="enabled">Whether to use the detection cache or not.</param>
+    void SetDetectionCacheEnabled(bool enabled);
+
+    /// <summary>
+    /// Start detecting the available dialog backend on a background thread (Linux only).<br>
+    /// Call this early during application startup, so the first dialog doesn't have to wait
+    /// for the detection or only waits for the part which is still outstanding.<br>
+    /// Calling this more than once has no effect.
+    /// </summary>
+    void Prewarm();
+
+    /// <summary>
+    /// Block until the detection started by Prewarm() has finished.<br>
+    /// Returns immediately if Prewarm() was never called.
+    /// </summary>
+    void WaitForPrewarm();
+
+    //-------------------------------------------------------------------------------------------------------------------//
+
+    /// <summary>
+    /// File filters which are parsed and validated once and can be reused for any number of dialogs.<br>
+    /// The filter arguments of every backend are built on first use and cached,
+    /// so applications with large filter lists (hundreds of extensions) should keep a set around instead of passing the vector every time.<br>
+    /// Empty patterns are dropped and invalid UTF-8 is replaced with U+FFFD.
+    /// On Linux patterns which would make the backend command exceed the argument size limit are left out.<br>
+    /// Copies share the parsed filters and are safe to use from multiple threads.
+    /// </summary>
+    class FilterSet
+    {
+    public:
+        struct Data;
+
+        /// <summary>
+        /// Parse the given filters.
+        /// </summary>
+        /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+        /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+        FilterSet(const std::vector<std::pair<std::string, std::string>>& filterPatterns, bool allFiles);
+
+        /// <summary>
+        /// Number of filters, without "All Files".
+        /// </summary>
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+
+        /// <summary>
+        /// Parsed filters, for use by ModernDialogs itself.
+        /// </summary>
+        [[nodiscard]] const Data& GetData() const noexcept;
+
+    private:
+        std::shared_ptr<const Data> m_data;
+    };
+
+    //-------------------------------------------------------------------------------------------------------------------//
+
     /// <summary>
     /// Open a Save File Dialog.
     /// </summary>
@@ -43,6 +115,15 @@ namespace MD
                          const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
                          bool allFiles = true);
 
+    /// <summary>
+    /// Open a Save File Dialog with a prepared filter set.
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filters">File filters.</param>
+    /// <returns>Path of the Dialog or empty string.</returns>
+    std::string SaveFile(const std::string& title, const std::string& defaultPathAndFile, const FilterSet& filters);
+
     //-------------------------------------------------------------------------------------------------------------------//
 
     /// <summary>
@@ -60,6 +141,19 @@ namespace MD
                                       bool allowMultipleSelects = false,
                                       bool allFiles = true);
 
+    /// <summary>
+    /// Opens an Open File Dialog with a prepared filter set.
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filters">File filters.</param>
+    /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+    /// <returns>Path(s) of the Dialog or empty vector.</returns>
+    std::vector<std::string> OpenFile(const std::string& title,
+                                      const std::string& defaultPathAndFile,
+                                      const FilterSet& filters,
+                                      bool allowMultipleSelects = false);
+
     /// <summary>
     /// Opens an Open File Dialog for a single file.<br>
     /// Alias for OpenFile();
@@ -88,6 +182,80 @@ namespace MD
                                                const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
                                                bool allFiles = true);
 
+    /// <summary>
+    /// Paths stored back to back in a single buffer, returned by OpenFileList().<br>
+    /// Every path is a view into that buffer and is followed by a null terminator,
+    /// so data() can be passed to C APIs directly. Copies share the buffer.
+    /// </summary>
+    class PathList
+    {
+    public:
+        using const_iterator = std::vector<std::string_view>::const_iterator;
+        using iterator = const_iterator;
+
+        PathList() = default;
+
+        /// <summary>
+        /// Copy the given paths into a single buffer.
+        /// </summary>
+        /// <param name="paths">Paths to copy.</param>
+        explicit PathList(const std::vector<std::string>& paths);
+
+        /// <summary>
+        /// Take over a buffer holding the paths.
+        /// </summary>
+        /// <param name="buffer">Buffer holding the paths.</param>
+        /// <param name="paths">Views into buffer, each one must be followed by a null terminator.</param>
+        PathList(std::shared_ptr<const char[]> buffer, std::vector<std::string_view> paths);
+
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+        [[nodiscard]] std::string_view operator[](std::size_t index) const noexcept;
+
+        [[nodiscard]] const_iterator begin() const noexcept;
+        [[nodiscard]] const_iterator end() const noexcept;
+
+        /// <summary>
+        /// Copy the paths into separate strings.
+        /// </summary>
+        /// <returns>Copied paths.</returns>
+        [[nodiscard]] std::vector<std::string> ToVector() const;
+
+    private:
+        std::shared_ptr<const char[]> m_buffer;
+        std::vector<std::string_view> m_paths;
+    };
+
+    /// <summary>
+    /// Opens an Open File Dialog, see OpenFile().<br>
+    /// Returns the paths in a single buffer instead of one string per path,
+    /// which avoids an allocation per path for selections of thousands of files.
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    /// <returns>Path(s) of the Dialog or empty list.</returns>
+    PathList OpenFileList(const std::string& title,
+                          const std::string& defaultPathAndFile = "",
+                          const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                          bool allowMultipleSelects = false,
+                          bool allFiles = true);
+
+    /// <summary>
+    /// Opens an Open File Dialog with a prepared filter set, see OpenFileList().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filters">File filters.</param>
+    /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+    /// <returns>Path(s) of the Dialog or empty list.</returns>
+    PathList OpenFileList(const std::string& title,
+                          const std::string& defaultPathAndFile,
+                          const FilterSet& filters,
+                          bool allowMultipleSelects = false);
+
     //-------------------------------------------------------------------------------------------------------------------//
 
     /// <summary>
@@ -178,6 +346,583 @@ namespace MD
     /// <param name="message">Message for the message box.</param>
     /// <returns>Selection made by the user.</returns>
     Selection ShowMsgBox(const std::string& title, const std::string& message);
+
+    //-------------------------------------------------------------------------------------------------------------------//
+
+    /// <summary>
+    /// Reusable Save File Dialog, for dialogs which are shown many times with the same settings.<br>
+    /// The arguments are validated and the backend command is built on construction, Show() reuses it.
+    /// The command is only built again if the backend or the window the dialog attaches to changed.<br>
+    /// Copies share the prepared command. Show() may be called from multiple threads.
+    /// </summary>
+    class SaveFileDialog
+    {
+    public:
+        struct State;
+
+        /// <summary>
+        /// Prepare a Save File Dialog, see SaveFile().
+        /// </summary>
+        /// <param name="title">Title for the Dialog.</param>
+        /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+        /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+        /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+        explicit SaveFileDialog(const std::string& title,
+                                const std::string& defaultPathAndFile = "",
+                                const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                bool allFiles = true);
+        SaveFileDialog(const std::string& title, const std::string& defaultPathAndFile, const FilterSet& filters);
+
+        /// <summary>
+        /// Show the dialog and block until it is closed.
+        /// </summary>
+        /// <returns>Path of the Dialog or empty string.</returns>
+        [[nodiscard]] std::string Show() const;
+
+    private:
+        std::shared_ptr<const State> m_state;
+    };
+
+    /// <summary>
+    /// Reusable Open File Dialog, see SaveFileDialog.
+    /// </summary>
+    class OpenFileDialog
+    {
+    public:
+        struct State;
+
+        /// <summary>
+        /// Prepare an Open File Dialog, see OpenFile().
+        /// </summary>
+        /// <param name="title">Title for the Dialog.</param>
+        /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+        /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+        /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+        /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+        explicit OpenFileDialog(const std::string& title,
+                                const std::string& defaultPathAndFile = "",
+                                const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                bool allowMultipleSelects = false,
+                                bool allFiles = true);
+        OpenFileDialog(const std::string& title,
+                       const std::string& defaultPathAndFile,
+                       const FilterSet& filters,
+                       bool allowMultipleSelects = false);
+
+        /// <summary>
+        /// Show the dialog and block until it is closed.
+        /// </summary>
+        /// <returns>Path(s) of the Dialog or empty vector.</returns>
+        [[nodiscard]] std::vector<std::string> Show() const;
+
+    private:
+        std::shared_ptr<const State> m_state;
+    };
+
+    /// <summary>
+    /// Reusable Select Folder Dialog, see SaveFileDialog.
+    /// </summary>
+    class FolderDialog
+    {
+    public:
+        struct State;
+
+        /// <summary>
+        /// Prepare a Select Folder Dialog, see SelectFolder().
+        /// </summary>
+        /// <param name="title">Title for the Dialog.</param>
+        /// <param name="defaultPath">Sets a default path.</param>
+        explicit FolderDialog(const std::string& title, const std::string& defaultPath = "");
+
+        /// <summary>
+        /// Show the dialog and block until it is closed.
+        /// </summary>
+        /// <returns>Path of the Select Folder Dialog or empty string.</returns>
+        [[nodiscard]] std::string Show() const;
+
+    private:
+        std::shared_ptr<const State> m_state;
+    };
+
+    /// <summary>
+    /// Reusable message box, see SaveFileDialog.<br>
+    /// Not called MessageBox, as windows.h defines a macro of that name.
+    /// </summary>
+    class MsgBox
+    {
+    public:
+        struct State;
+
+        /// <summary>
+        /// Prepare a message box, see ShowMsgBox().
+        /// </summary>
+        /// <param name="title">Title for the message box.</param>
+        /// <param name="message">Message for the message box.</param>
+        /// <param name="style">Style for the message box.</param>
+        /// <param name="buttons">Button(s) for the message box.</param>
+        MsgBox(const std::string& title, const std::string& message, Style style = Style::Info, Buttons buttons = Buttons::OK);
+
+        /// <summary>
+        /// Show the message box and block until it is closed.
+        /// </summary>
+        /// <returns>Selection made by the user.</returns>
+        [[nodiscard]] Selection Show() const;
+
+    private:
+        std::shared_ptr<const State> m_state;
+    };
+
+    //-------------------------------------------------------------------------------------------------------------------//
+
+    /// <summary>
+    /// Executor used to run completion callbacks of asynchronous dialogs.<br>
+    /// Receives the callback invocation as a task, e.g. to queue it for the main thread.
+    /// </summary>
+    using CompletionExecutor = std::function<void(std::function<void()>)>;
+
+    /// <summary>
+    /// Set the executor which runs the completion callbacks of asynchronous dialogs.<br>
+    /// Without an executor (default) callbacks run one after another on an internal completion thread on Linux
+    /// and on the thread of their dialog on Windows.
+    /// A callback that blocks, for example by showing another dialog, only delays the callbacks queued after it.<br>
+    /// On Linux the executor itself is called on the internal thread waiting for the dialogs, it must hand the task
+    /// off instead of running it.<br>
+    /// Futures returned by the asynchronous dialogs are not affected by this.
+    /// </summary>
+    /// <param name="executor">Executor to use or an empty function to invoke callbacks directly.</param>
+    void SetCompletionExecutor(CompletionExecutor executor);
+
+    /// <summary>
+    /// Non-blocking version of SaveFile().<br>
+    /// On Linux all asynchronous dialogs are waited on by a single shared background thread.
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    /// <returns>Future receiving the path of the Dialog or empty string.</returns>
+    std::future<std::string> SaveFileAsync(const std::string& title,
+                                           const std::string& defaultPathAndFile = "",
+                                           const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                           bool allFiles = true);
+
+    /// <summary>
+    /// Non-blocking version of SaveFile() which reports the result through a callback.
+    /// </summary>
+    /// <param name="callback">Receives the path of the Dialog or empty string, see SetCompletionExecutor().</param>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    void SaveFileAsync(std::function<void(std::string)> callback,
+                       const std::string& title,
+                       const std::string& defaultPathAndFile = "",
+                       const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                       bool allFiles = true);
+
+    /// <summary>
+    /// Non-blocking version of OpenFile().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    /// <returns>Future receiving the path(s) of the Dialog or empty vector.</returns>
+    std::future<std::vector<std::string>> OpenFileAsync(const std::string& title,
+                                                        const std::string& defaultPathAndFile = "",
+                                                        const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                                        bool allowMultipleSelects = false,
+                                                        bool allFiles = true);
+
+    /// <summary>
+    /// Non-blocking version of OpenFile() which reports the result through a callback.
+    /// </summary>
+    /// <param name="callback">Receives the path(s) of the Dialog or empty vector, see SetCompletionExecutor().</param>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    void OpenFileAsync(std::function<void(std::vector<std::string>)> callback,
+                       const std::string& title,
+                       const std::string& defaultPathAndFile = "",
+                       const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                       bool allowMultipleSelects = false,
+                       bool allFiles = true);
+
+    /// <summary>
+    /// Non-blocking version of SelectFolder().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPath">Sets a default path and file.</param>
+    /// <returns>Future receiving the path of the Select Folder Dialog or empty string.</returns>
+    std::future<std::string> SelectFolderAsync(const std::string& title, const std::string& defaultPath = "");
+
+    /// <summary>
+    /// Non-blocking version of SelectFolder() which reports the result through a callback.
+    /// </summary>
+    /// <param name="callback">Receives the path of the Select Folder Dialog or empty string, see SetCompletionExecutor().</param>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPath">Sets a default path and file.</param>
+    void SelectFolderAsync(std::function<void(std::string)> callback, const std::string& title, const std::string& defaultPath = "");
+
+    /// <summary>
+    /// Non-blocking version of ShowMsgBox().
+    /// </summary>
+    /// <param name="title">Title for the message box.</param>
+    /// <param name="message">Message for the message box.</param>
+    /// <param name="style">Style for the message box.</param>
+    /// <param name="buttons">Button(s) for the message box.</param>
+    /// <returns>Future receiving the selection made by the user.</returns>
+    std::future<Selection> ShowMsgBoxAsync(const std::string& title,
+                                           const std::string& message,
+                                           Style style = Style::Info,
+                                           Buttons buttons = Buttons::OK);
+
+    /// <summary>
+    /// Non-blocking version of ShowMsgBox() which reports the result through a callback.
+    /// </summary>
+    /// <param name="callback">Receives the selection made by the user, see SetCompletionExecutor().</param>
+    /// <param name="title">Title for the message box.</param>
+    /// <param name="message">Message for the message box.</param>
+    /// <param name="style">Style for the message box.</param>
+    /// <param name="buttons">Button(s) for the message box.</param>
+    void ShowMsgBoxAsync(std::function<void(Selection)> callback,
+                         const std::string& title,
+                         const std::string& message,
+                         Style style = Style::Info,
+                         Buttons buttons = Buttons::OK);
+
+    //-------------------------------------------------------------------------------------------------------------------//
+
+    /// <summary>
+    /// Set a timeout after which dialogs get closed automatically (Linux only, disabled by default).<br>
+    /// Closed dialogs return an empty path, an empty vector or MD::Selection::None.<br>
+    /// Applies to blocking and non-blocking dialogs opened after this call.
+    /// </summary>
+    /// <param name="timeout">Timeout or zero to disable it.</param>
+    void SetDialogTimeout(std::chrono::milliseconds timeout);
+
+    /// <summary>
+    /// Set a timeout for checking the paths returned by the file and folder dialogs (disabled by default).<br>
+    /// Keeps a hung network mount from blocking the caller, the check keeps running in the background.<br>
+    /// Dialogs whose paths could not be checked in time return an empty path or an empty vector.
+    /// </summary>
+    /// <param name="timeout">Timeout or zero to disable it.</param>
+    void SetPathValidationTimeout(std::chrono::milliseconds timeout);
+
+    /// <summary>
+    /// Phase of a dialog call reported to the trace sink.
+    /// </summary>
+    enum class TracePhase
+    {
+        Detection,    //Backend detection, one event per executable lookup and probe
+        CommandBuild, //Building the argument vector of the backend (includes querying the active window)
+        Spawn,        //Starting the backend process
+        Run,          //From the start of the backend process until it exited (includes waiting for the user)
+        Parse,        //Parsing the output of the backend
+        Validate      //Checking the returned paths
+    };
+
+    /// <summary>
+    /// Timing of a single phase of a dialog call.
+    /// </summary>
+    struct TraceEvent
+    {
+        TracePhase Phase;
+        //Backend the phase belongs to (e.g. "zenity"), empty if it isn't specific to one
+        std::string_view Backend;
+        //Additional information (e.g. which probe ran), may be empty
+        std::string_view Detail;
+        std::chrono::steady_clock::time_point Start;
+        std::chrono::steady_clock::time_point End;
+    };
+
+    using TraceSink = std::function<void(const TraceEvent& event)>;
+
+    /// <summary>
+    /// Set a sink which receives the timing of every phase of a dialog call (Linux only, disabled by default).<br>
+    /// The sink is invoked on the thread running the phase, which may be an internal thread, so it should return quickly.<br>
+    /// Define MD_DISABLE_TRACING when compiling ModernDialogs to remove tracing entirely.
+    /// </summary>
+    /// <param name="sink">Sink to use or an empty function to disable tracing.</param>
+    void SetTraceSink(TraceSink sink);
+
+    /// <summary>
+    /// Set the maximum number of bytes read from the output of a dialog backend (Linux only, defaults to 64 MiB).<br>
+    /// Dialogs exceeding it are treated as failed and return an empty path, an empty vector or MD::Selection::Error.
+    /// </summary>
+    /// <param name="bytes">Maximum output size in bytes.</param>
+    void SetMaxDialogOutputSize(std::size_t bytes);
+
+    /// <summary>
+    /// Run tkinter dialogs in one long-lived Python process instead of starting Python for every dialog
+    /// (Linux only, disabled by default).<br>
+    /// Enabling starts the helper in the background, disabling stops it once the queued dialogs are done.<br>
+    /// tkinter dialogs run one after another while the helper is enabled.
+    /// </summary>
+    /// <param name="enabled">Whether to use the helper.</param>
+    void SetTKinterHelperEnabled(bool enabled);
+
+    /// <summary>
+    /// Show the file dialogs with GTK in-process instead of starting a backend process (Linux only, disabled by default).<br>
+    /// libgtk-3 (or libgtk-4 if GTK 3 is missing) is loaded and initialized on its own thread by the first file dialog,
+    /// later dialogs reuse it. Without GTK the regular backends are used.<br>
+    /// Not meant for applications which use GTK themselves, as GTK would end up running on a second thread.
+    /// </summary>
+    /// <param name="enabled">Whether to use GTK.</param>
+    void SetGTKBackendEnabled(bool enabled);
+
+    /// <summary>
+    /// Normalize the paths returned by the file dialogs to Unicode NFC (Linux only, disabled by default).<br>
+    /// Uses GLib, which is loaded on first use, ASCII paths skip it. Without GLib paths are returned as is.<br>
+    /// Linux filesystems compare names byte by byte, a normalized path may not open a file whose name is stored
+    /// decomposed. Meant for applications which compare or store paths as text.
+    /// </summary>
+    /// <param name="enabled">Whether to normalize returned paths.</param>
+    void SetPathNormalizationEnabled(bool enabled);
+
+    /// <summary>
+    /// Limit the number of dialogs shown at the same time (Linux only, 0 for no limit, the default).<br>
+    /// Further dialogs wait in a queue: file dialogs first, then message boxes by style (Error, Warning, Question, Info),
+    /// in the order they were opened within each group. Blocking calls wait for their turn, asynchronous ones are
+    /// started later. A dialog handle cancelled while waiting leaves the queue and completes right away, without being shown.<br>
+    /// Dialogs opened before the limit was set don't count towards it. Dialog requests (Request*()) are driven
+    /// by the event loop of the application and are never queued.
+    /// </summary>
+    /// <param name="count">Maximum number of simultaneous dialogs or 0 for no limit.</param>
+    void SetMaxConcurrentDialogs(std::size_t count);
+
+    /// <summary>
+    /// Show identical message boxes (same title, message, style and buttons) only once (Linux only, disabled by default).<br>
+    /// ShowMsgBox() and ShowMsgBoxAsync() calls join an identical message box which is waiting or shown,
+    /// and all of them receive its selection. A message box which was joined while waiting shows how often
+    /// the message occurred.
+    /// </summary>
+    /// <param name="enabled">Whether to coalesce identical message boxes.</param>
+    void SetMsgBoxCoalescingEnabled(bool enabled);
+
+    /// <summary>
+    /// Set the window dialogs get attached to (none by default).<br>
+    /// Takes an X11 window id on Linux and a HWND on Windows.
+    /// Without it the active window is looked up for every dialog (on Linux only by backends able to attach).
+    /// </summary>
+    /// <param name="window">Parent window or 0 to use the active window again.</param>
+    void SetParentWindow(uint64_t window);
+
+    /// <summary>
+    /// Handle for an outstanding dialog, returned by the Launch*() functions.<br>
+    /// Copies refer to the same dialog. Destroying the handle does not close the dialog.
+    /// </summary>
+    template<typename T>
+    class DialogHandle
+    {
+    public:
+        struct State;
+
+        DialogHandle() = default;
+        explicit DialogHandle(std::shared_ptr<State> state);
+
+        /// <summary>
+        /// Whether this handle refers to a dialog.
+        /// </summary>
+        [[nodiscard]] bool Valid() const;
+
+        /// <summary>
+        /// Whether the result of the dialog is available.
+        /// </summary>
+        [[nodiscard]] bool IsDone() const;
+
+        /// <summary>
+        /// Close the dialog, it then returns an empty path, an empty vector or MD::Selection::None.<br>
+        /// On Linux the backend process and its children are killed, a dialog still waiting because of
+        /// MD::SetMaxConcurrentDialogs() is removed from the queue.
+        /// On Windows the dialog stays open until the user closes it, but its result is discarded.
+        /// </summary>
+        void Cancel();
+
+        /// <summary>
+        /// Block until the result of the dialog is available.
+        /// </summary>
+        void Wait() const;
+
+        /// <summary>
+        /// Block until the result of the dialog is available or the timeout expired.<br>
+        /// The dialog stays open if the timeout expires.
+        /// </summary>
+        /// <param name="timeout">Maximum time to wait.</param>
+        /// <returns>Whether the result is available.</returns>
+        [[nodiscard]] bool WaitFor(std::chrono::milliseconds timeout) const;
+
+        /// <summary>
+        /// Block until the result of the dialog is available and return it.
+        /// </summary>
+        /// <returns>Result of the dialog.</returns>
+        [[nodiscard]] T Get() const;
+
+    private:
+        std::shared_ptr<State> m_state;
+    };
+
+    /// <summary>
+    /// Open a Save File Dialog without blocking, see SaveFile().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    /// <returns>Handle for the dialog.</returns>
+    DialogHandle<std::string> LaunchSaveFile(const std::string& title,
+                                             const std::string& defaultPathAndFile = "",
+                                             const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                             bool allFiles = true);
+
+    /// <summary>
+    /// Open an Open File Dialog without blocking, see OpenFile().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    /// <returns>Handle for the dialog.</returns>
+    DialogHandle<std::vector<std::string>> LaunchOpenFile(const std::string& title,
+                                                          const std::string& defaultPathAndFile = "",
+                                                          const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                                          bool allowMultipleSelects = false,
+                                                          bool allFiles = true);
+
+    /// <summary>
+    /// Open a Select Folder Dialog without blocking, see SelectFolder().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPath">Sets a default path and file.</param>
+    /// <returns>Handle for the dialog.</returns>
+    DialogHandle<std::string> LaunchSelectFolder(const std::string& title, const std::string& defaultPath = "");
+
+    /// <summary>
+    /// Open a message box without blocking, see ShowMsgBox().
+    /// </summary>
+    /// <param name="title">Title for the message box.</param>
+    /// <param name="message">Message for the message box.</param>
+    /// <param name="style">Style for the message box.</param>
+    /// <param name="buttons">Button(s) for the message box.</param>
+    /// <returns>Handle for the dialog.</returns>
+    DialogHandle<Selection> LaunchMsgBox(const std::string& title,
+                                         const std::string& message,
+                                         Style style = Style::Info,
+                                         Buttons buttons = Buttons::OK);
+
+    //-------------------------------------------------------------------------------------------------------------------//
+
+    /// <summary>
+    /// Low-level dialog for applications with their own event loop (epoll, libuv, Qt, ...), returned by the Request*() functions.<br>
+    /// The request only makes progress while the owner calls OnReadable() or TryGetResult().<br>
+    /// On Linux its process is started by the internal thread of the asynchronous dialogs, so the request may outlive the thread which created it.<br>
+    /// Destroying an unfinished request closes its dialog.
+    /// </summary>
+    template<typename T>
+    class DialogRequest
+    {
+    public:
+        struct State;
+
+        DialogRequest();
+        explicit DialogRequest(std::unique_ptr<State> state);
+        ~DialogRequest();
+
+        DialogRequest(const DialogRequest&) = delete;
+        DialogRequest& operator=(const DialogRequest&) = delete;
+        DialogRequest(DialogRequest&&) noexcept;
+        DialogRequest& operator=(DialogRequest&&) noexcept;
+
+        /// <summary>
+        /// File descriptor to wait on for readability (Linux only).<br>
+        /// Call OnReadable() whenever it becomes readable.
+        /// </summary>
+        /// <returns>Non-blocking read end of the backend's stdout pipe or -1 if there is nothing to wait for.</returns>
+        [[nodiscard]] int GetFd() const;
+
+        /// <summary>
+        /// Time left until the timeout set by SetDialogTimeout() closes the dialog (Linux only).<br>
+        /// The dialog doesn't write anything when the timeout expires, so wait on GetFd() for at most this long
+        /// (e.g. as the timeout of poll() or epoll_wait(), or with a timer of the event loop) and call OnReadable() afterwards.
+        /// </summary>
+        /// <returns>Milliseconds (rounded up), 0 if the timeout has expired or -1 if there is no timeout.</returns>
+        [[nodiscard]] int32_t GetTimeout() const;
+
+        /// <summary>
+        /// Consume the output which is available on GetFd().<br>
+        /// Also enforces the timeout set by SetDialogTimeout(), see GetTimeout().
+        /// </summary>
+        /// <returns>Whether the result of the dialog is available.</returns>
+        bool OnReadable();
+
+        /// <summary>
+        /// Retrieve the result of the dialog without blocking.
+        /// </summary>
+        /// <returns>Result of the dialog or std::nullopt if it is still open.</returns>
+        [[nodiscard]] std::optional<T> TryGetResult();
+
+        /// <summary>
+        /// Close the dialog, it then returns an empty path, an empty vector or MD::Selection::None.<br>
+        /// The result becomes available through OnReadable() as usual.
+        /// </summary>
+        void Cancel();
+
+    private:
+        std::unique_ptr<State> m_state;
+    };
+
+    /// <summary>
+    /// Open a Save File Dialog driven by an external event loop, see SaveFile().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    /// <returns>Request for the dialog.</returns>
+    DialogRequest<std::string> RequestSaveFile(const std::string& title,
+                                               const std::string& defaultPathAndFile = "",
+                                               const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                               bool allFiles = true);
+
+    /// <summary>
+    /// Open an Open File Dialog driven by an external event loop, see OpenFile().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPathAndFile">Sets a default path and file.</param>
+    /// <param name="filterPatterns">File filters (Separate multiple extensions for the same filter with a ';'. Example: {"Test File", "*.Test;*.TS"}.</param>
+    /// <param name="allowMultipleSelects">Whether to allow multiple file selections or not.</param>
+    /// <param name="allFiles">Whether to add a filter for "All Files (*.*)" or not.</param>
+    /// <returns>Request for the dialog.</returns>
+    DialogRequest<std::vector<std::string>> RequestOpenFile(const std::string& title,
+                                                            const std::string& defaultPathAndFile = "",
+                                                            const std::vector<std::pair<std::string, std::string>>& filterPatterns = {},
+                                                            bool allowMultipleSelects = false,
+                                                            bool allFiles = true);
+
+    /// <summary>
+    /// Open a Select Folder Dialog driven by an external event loop, see SelectFolder().
+    /// </summary>
+    /// <param name="title">Title for the Dialog.</param>
+    /// <param name="defaultPath">Sets a default path and file.</param>
+    /// <returns>Request for the dialog.</returns>
+    DialogRequest<std::string> RequestSelectFolder(const std::string& title, const std::string& defaultPath = "");
+
+    /// <summary>
+    /// Open a message box driven by an external event loop, see ShowMsgBox().
+    /// </summary>
+    /// <param name="title">Title for the message box.</param>
+    /// <param name="message">Message for the message box.</param>
+    /// <param name="style">Style for the message box.</param>
+    /// <param name="buttons">Button(s) for the message box.</param>
+    /// <returns>Request for the dialog.</returns>
+    DialogRequest<Selection> RequestMsgBox(const std::string& title,
+                                           const std::string& message,
+                                           Style style = Style::Info,
+                                           Buttons buttons = Buttons::OK);
 }
 
 #endif /*_GAMESTRAP_MODERNDIALOGS_H_*/
\ No newline at end of file
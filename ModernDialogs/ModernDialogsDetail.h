@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _GAMESTRAP_MODERNDIALOGS_DETAIL_H_
+#define _GAMESTRAP_MODERNDIALOGS_DETAIL_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Internal helpers of ModernDialogs.
+//These are not part of the public API and may change at any time, they are only exposed for the benchmarks and tests.
+namespace MD::Detail
+{
+    /// <summary>
+    /// Resolve every executable ModernDialogs may use with the single in-process PATH walk of the backend detection.<br>
+    /// Always finds nothing on Windows.
+    /// </summary>
+    /// <returns>Number of executables found.</returns>
+    std::size_t ResolveExecutables();
+
+    /// <summary>
+    /// Split the output of a file dialog into its paths.<br>
+    /// Runs in a single linear pass, empty paths are skipped.
+    /// </summary>
+    /// <param name="output">Output of the backend.</param>
+    /// <param name="separator">Separator terminating the paths in the output.</param>
+    /// <returns>Views into output, one per path.</returns>
+    [[nodiscard]] std::vector<std::string_view> SplitPaths(std::string_view output, char separator);
+
+    /// <summary>
+    /// Find the first character of text which is one of characters.<br>
+    /// Scans 16 or 32 bytes at a time with SSE2, AVX2 or NEON where available, characters should be a short set.
+    /// </summary>
+    /// <param name="text">Text to scan.</param>
+    /// <param name="characters">Characters to look for.</param>
+    /// <param name="pos">Index to start the scan at.</param>
+    /// <returns>Index of the first match or std::string_view::npos.</returns>
+    [[nodiscard]] std::size_t FindFirstOf(std::string_view text, std::string_view characters, std::size_t pos = 0) noexcept;
+
+    /// <summary>
+    /// Append text to out escaped for the inside of a single quoted Python string literal.
+    /// </summary>
+    /// <param name="out">String to append to.</param>
+    /// <param name="text">Text to escape.</param>
+    void AppendPythonEscaped(std::string& out, std::string_view text);
+
+    /// <summary>
+    /// Append text to out escaped for Pango markup, as used by the --text of zenity and yad.
+    /// </summary>
+    /// <param name="out">String to append to.</param>
+    /// <param name="text">Text to escape.</param>
+    void AppendMarkupEscaped(std::string& out, std::string_view text);
+
+    /// <summary>
+    /// Find the first byte of text which isn't ASCII, scanning 16 or 32 bytes at a time like FindFirstOf().
+    /// </summary>
+    /// <param name="text">Text to scan.</param>
+    /// <param name="pos">Index to start the scan at.</param>
+    /// <returns>Index of the first byte >= 0x80 or std::string_view::npos.</returns>
+    [[nodiscard]] std::size_t FindFirstNonASCII(std::string_view text, std::size_t pos = 0) noexcept;
+
+    /// <summary>
+    /// Find the first ill-formed UTF-8 sequence in text.<br>
+    /// Runs of ASCII are skipped with FindFirstNonASCII(), overlong forms, surrogates and code points
+    /// above U+10FFFF are rejected.
+    /// </summary>
+    /// <param name="text">Text to validate.</param>
+    /// <param name="pos">Index of a sequence start to begin the validation at.</param>
+    /// <returns>Index of the first invalid byte or std::string_view::npos if text is valid.</returns>
+    [[nodiscard]] std::size_t FindInvalidUTF8(std::string_view text, std::size_t pos = 0) noexcept;
+
+    /// <summary>
+    /// Append text to out, replacing every maximal ill-formed subsequence with U+FFFD.
+    /// </summary>
+    /// <param name="out">String to append to.</param>
+    /// <param name="text">Text to sanitize.</param>
+    void AppendSanitizedUTF8(std::string& out, std::string_view text);
+
+    /// <summary>
+    /// Normalize text to Unicode NFC in place.<br>
+    /// ASCII text is returned as is, anything else goes through g_utf8_normalize() of GLib, which is loaded on first use.
+    /// Text stays untouched if it isn't valid UTF-8 or GLib is unavailable (always on Windows).
+    /// </summary>
+    /// <param name="text">Text to normalize.</param>
+    /// <returns>Whether text was changed.</returns>
+    bool NormalizeToNFC(std::string& text);
+}
+
+#endif /*_GAMESTRAP_MODERNDIALOGS_DETAIL_H_*/
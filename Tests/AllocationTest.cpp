@@ -0,0 +1,165 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <ModernDialogs.h>
+
+#include "Tests.h"
+
+//Checks that a warm call of every public dialog function stays within a fixed number of allocations.
+//Every call runs against the stub backends and has to return the canned answer of the stub, otherwise the test fails.
+
+namespace
+{
+	std::atomic<uint64_t> AllocationCount{0};
+}
+
+//Counting hooks for the whole test binary, the other operator new and delete variants forward to these
+
+void* operator new(const std::size_t size)
+{
+	AllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	if(void* const ptr = std::malloc(size != 0 ? size : 1))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* const ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* const ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+namespace
+{
+	constexpr std::array<MD::Style, 4> Styles{MD::Style::Info, MD::Style::Warning, MD::Style::Error, MD::Style::Question};
+	constexpr std::array<const char*, 4> StyleNames{"Info", "Warning", "Error", "Question"};
+	constexpr std::array<MD::Buttons, 4> ButtonSets{MD::Buttons::OK, MD::Buttons::OKCancel, MD::Buttons::YesNo, MD::Buttons::Quit};
+	constexpr std::array<const char*, 4> ButtonSetNames{"OK", "OKCancel", "YesNo", "Quit"};
+
+	//Maximum number of allocations of a single warm call, including the ones for its result.
+	//Lower these when the hot path gets cheaper, so regressions show up.
+	constexpr uint64_t SaveFileBudget = 22;
+	constexpr uint64_t OpenFileBudget = 22;
+	constexpr uint64_t SelectFolderBudget = 12;
+	constexpr uint64_t MsgBoxBudget = 10;
+
+	//Returns whether the stub answered the dialog
+	using DialogOperation = bool(*)(MD::Style style, MD::Buttons buttons);
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Count the allocations of a warm call in a child process, after a first call did the backend detection.<br>
+	/// Prints the result line of the call.
+	/// </summary>
+	/// <returns>Whether both calls were answered by the stub and the warm call stayed within the budget.</returns>
+	[[nodiscard]] bool CheckAllocations(const std::string& name, const char* const backend, const DialogOperation operation,
+	                                    const MD::Style style, const MD::Buttons buttons, const uint64_t budget)
+	{
+		return Tests::RunInChild([&]
+		{
+			//Relative default paths start in the working directory, a fixed one keeps the counts independent of the checkout path
+			const bool detected = Tests::UseStubBackend(backend) && chdir("/") == 0 && operation(style, buttons);
+
+			const uint64_t start = AllocationCount.load();
+			const bool answered = detected && operation(style, buttons);
+			const uint64_t count = AllocationCount.load() - start;
+
+			std::cout << std::left << std::setw(52) << name << std::right;
+			if(!answered)
+			{
+				std::cout << " FAILED, the stub didn't answer\n";
+				return false;
+			}
+
+			std::cout << " allocations=" << std::setw(5) << count << " budget=" << std::setw(5) << budget
+			          << (count > budget ? "  OVER BUDGET\n" : "\n");
+
+			return count <= budget;
+		});
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+int main()
+{
+#ifdef __linux__
+	std::cout << "Allocations of a warm dialog call with stub backends\n";
+
+	bool passed = true;
+
+	for(const char* const backend : Tests::StubBackends)
+	{
+		const std::string prefix = std::string("  ") + backend + ' ';
+
+		passed &= CheckAllocations(prefix + "SaveFile", backend,
+		                           [](MD::Style, MD::Buttons){ return !MD::SaveFile("Title", "File.txt", {{"Text", "*.txt"}}).empty(); },
+		                           MD::Style::Info, MD::Buttons::OK, SaveFileBudget);
+		passed &= CheckAllocations(prefix + "OpenFile", backend,
+		                           [](MD::Style, MD::Buttons){ return !MD::OpenFile("Title", "", {{"Text", "*.txt"}}).empty(); },
+		                           MD::Style::Info, MD::Buttons::OK, OpenFileBudget);
+		passed &= CheckAllocations(prefix + "SelectFolder", backend,
+		                           [](MD::Style, MD::Buttons){ return !MD::SelectFolder("Title").empty(); },
+		                           MD::Style::Info, MD::Buttons::OK, SelectFolderBudget);
+
+		for(std::size_t style = 0; style < Styles.size(); ++style)
+		{
+			for(std::size_t buttons = 0; buttons < ButtonSets.size(); ++buttons)
+			{
+				passed &= CheckAllocations(prefix + "ShowMsgBox " + StyleNames[style] + ' ' + ButtonSetNames[buttons], backend,
+				                           [](const MD::Style s, const MD::Buttons b){ return Tests::IsSelectionOf(b, MD::ShowMsgBox("Title", "Message", s, b)); },
+				                           Styles[style], ButtonSets[buttons], MsgBoxBudget);
+			}
+		}
+	}
+
+	return passed ? 0 : 1;
+#else
+	std::cout << "Allocation budgets need fork() and the stub backends, skipped\n";
+
+	return 0;
+#endif
+}
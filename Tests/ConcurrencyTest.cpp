@@ -0,0 +1,247 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#endif
+
+#include <ModernDialogs.h>
+
+#include "Tests.h"
+
+//Fires dialogs from many threads against stub backends, so backend detection, spawning and parsing run concurrently.
+//premake builds this test with -fsanitize=thread on Linux x86_64, any data race makes ThreadSanitizer fail the run.
+
+namespace
+{
+	constexpr uint32_t ThreadCount = 16;
+	constexpr uint32_t CallsPerThread = 8;
+	//Time a cancelled or answered dialog gets to complete, way above what it needs
+	constexpr std::chrono::milliseconds CompletionTimeout{5000};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Run one dialog call of the mix, blocking and asynchronous calls alternate between threads.
+	/// </summary>
+	/// <returns>Whether the stub answered the dialog.</returns>
+	[[nodiscard]] bool RunDialog(const uint32_t thread, const uint32_t call)
+	{
+		const bool async = thread % 2 != 0;
+
+		switch((thread + call) % 4)
+		{
+		case 0:
+			return Tests::IsSelectionOf(MD::Buttons::OKCancel,
+			                            async ? MD::ShowMsgBoxAsync("Title", "Message", MD::Style::Info, MD::Buttons::OKCancel).get() :
+			                                    MD::ShowMsgBox("Title", "Message", MD::Style::Info, MD::Buttons::OKCancel));
+
+		case 1:
+			return !(async ? MD::OpenFileAsync("Title", "", {{"Text", "*.txt"}}, true).get() :
+			                 MD::OpenFile("Title", "", {{"Text", "*.txt"}}, true)).empty();
+
+		case 2:
+			return !(async ? MD::SaveFileAsync("Title", "File.txt").get() : MD::SaveFile("Title", "File.txt")).empty();
+
+		default:
+			MD::Prewarm();
+			return !(async ? MD::SelectFolderAsync("Title").get() : MD::SelectFolder("Title")).empty();
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Start every thread at once and let each of them run CallsPerThread dialogs.
+	/// </summary>
+	/// <returns>Number of dialogs which weren't answered.</returns>
+	[[nodiscard]] uint32_t RunConcurrentDialogs()
+	{
+		std::atomic<bool> start = false;
+		std::atomic<uint32_t> failures = 0;
+		std::vector<std::thread> threads{};
+		threads.reserve(ThreadCount);
+
+		for(uint32_t i = 0; i < ThreadCount; ++i)
+		{
+			threads.emplace_back([&start, &failures, i]()
+			{
+				while(!start)
+					std::this_thread::yield();
+
+				for(uint32_t j = 0; j < CallsPerThread; ++j)
+				{
+					if(!RunDialog(i, j))
+						++failures;
+				}
+			});
+		}
+
+		start = true;
+		for(std::thread& thread : threads)
+			thread.join();
+
+		return failures;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Run the dialogs once with cold library state and once more through the dialog scheduler with coalescing.
+	/// </summary>
+	/// <returns>Whether every dialog was answered.</returns>
+	[[nodiscard]] bool RunTest(const char* const backend)
+	{
+		if(!Tests::UseStubBackend(backend))
+			return false;
+
+		const uint32_t coldFailures = RunConcurrentDialogs();
+
+		MD::SetMaxConcurrentDialogs(3);
+		MD::SetMsgBoxCoalescingEnabled(true);
+		const uint32_t scheduledFailures = RunConcurrentDialogs();
+
+		if(coldFailures != 0 || scheduledFailures != 0)
+		{
+			std::cerr << "  " << backend << ": " << coldFailures << " cold and " << scheduledFailures
+			          << " scheduled dialogs failed\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Cancel a dialog queued behind a message box which stays open, with room for a single dialog.
+	/// </summary>
+	/// <returns>Whether the queued dialog completed right away and the slot of the message box got released.</returns>
+	[[nodiscard]] bool RunQueuedCancelTest()
+	{
+		if(!Tests::UseStubBackend(Tests::BlockingStubBackend))
+			return false;
+
+		MD::SetMaxConcurrentDialogs(1);
+
+		MD::DialogHandle<MD::Selection> shown = MD::LaunchMsgBox("Title", "Message", MD::Style::Info, MD::Buttons::OK);
+		MD::DialogHandle<std::string> queued = MD::LaunchSaveFile("Title", "File.txt");
+
+		queued.Cancel();
+		const bool queuedCancelled = queued.WaitFor(CompletionTimeout) && queued.Get().empty() && !shown.IsDone();
+
+		shown.Cancel();
+		const bool shownCancelled = shown.WaitFor(CompletionTimeout) && shown.Get() == MD::Selection::None;
+
+		MD::DialogHandle<std::string> next = MD::LaunchSaveFile("Title", "File.txt");
+		const bool nextAnswered = next.WaitFor(CompletionTimeout) && !next.Get().empty();
+
+		if(!queuedCancelled)
+			std::cerr << "  The cancelled dialog didn't leave the queue\n";
+		if(!shownCancelled)
+			std::cerr << "  The shown message box didn't close\n";
+		if(!nextAnswered)
+			std::cerr << "  The next dialog didn't get a slot\n";
+
+		return queuedCancelled && shownCancelled && nextAnswered;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+#ifdef __linux__
+	/// <summary>
+	/// Create a dialog request on a thread which exits right away, the dialog has to stay open until it gets cancelled.
+	/// </summary>
+	/// <returns>Whether the dialog outlived the thread and got cancelled.</returns>
+	[[nodiscard]] bool RunRequestThreadTest()
+	{
+		if(!Tests::UseStubBackend(Tests::BlockingStubBackend))
+			return false;
+
+		MD::DialogRequest<MD::Selection> request{};
+		std::thread([&request]{ request = MD::RequestMsgBox("Title", "Message"); }).join();
+
+		//The output pipe only becomes readable once the process exits
+		pollfd pollFd{request.GetFd(), POLLIN, 0};
+		const bool outlivedThread = pollFd.fd >= 0 && poll(&pollFd, 1, 200) == 0;
+
+		request.Cancel();
+		const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + CompletionTimeout;
+		while(!request.OnReadable() && std::chrono::steady_clock::now() < deadline)
+			static_cast<void>(poll(&pollFd, 1, 100));
+		const std::optional<MD::Selection> selection = request.TryGetResult();
+		const bool cancelled = selection && *selection == MD::Selection::None;
+
+		if(!outlivedThread)
+			std::cerr << "  The dialog got closed when the thread which created the request exited\n";
+		if(!cancelled)
+			std::cerr << "  The request didn't complete after it got cancelled\n";
+
+		return outlivedThread && cancelled;
+	}
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+int main()
+{
+#ifdef __linux__
+	std::cout << "Concurrent dialog calls (" << ThreadCount << " threads x " << CallsPerThread << " calls) with stub backends\n";
+
+	bool passed = true;
+
+	for(const char* const backend : Tests::StubBackends)
+	{
+		const bool backendPassed = Tests::RunInChild([backend]{ return RunTest(backend); });
+		std::cout << "  " << backend << (backendPassed ? " passed\n" : " FAILED\n");
+
+		passed &= backendPassed;
+	}
+
+	const bool cancelPassed = Tests::RunInChild(RunQueuedCancelTest);
+	std::cout << "  cancel while queued" << (cancelPassed ? " passed\n" : " FAILED\n");
+	passed &= cancelPassed;
+
+	const bool requestPassed = Tests::RunInChild(RunRequestThreadTest);
+	std::cout << "  request outliving its thread" << (requestPassed ? " passed\n" : " FAILED\n");
+	passed &= requestPassed;
+
+	return passed ? 0 : 1;
+#else
+	std::cout << "Concurrent dialog calls need fork() and the stub backends, skipped\n";
+
+	return 0;
+#endif
+}
@@ -0,0 +1,180 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <ModernDialogsDetail.h>
+
+//Compares the vectorised scans of ModernDialogs with one character at a time versions of them.
+//Lengths up to MaxLength cover the scalar tail and one to several 16 and 32 byte blocks.
+
+namespace
+{
+	constexpr std::size_t MaxLength = 100;
+	constexpr uint32_t RandomTextsPerLength = 2000;
+	//Characters the scans look for, mixed into the random texts a lot more often than other bytes
+	constexpr std::string_view SpecialCharacters{"\\/:*?\"<>|'\n\r&\0\x80\xff", 17};
+	constexpr std::string_view FilenameCharacters = "\\/:*?\"<>|";
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void AppendPythonEscapedScalar(std::string& out, const std::string_view text)
+	{
+		for(const char c : text)
+		{
+			if(c == '\n')
+				out += "\\n";
+			else if(c == '\r')
+				out += "\\r";
+			else if(c == '\0')
+				out += "\\x00";
+			else if(c == '\\' || c == '\'')
+			{
+				out += '\\';
+				out += c;
+			}
+			else
+				out += c;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void AppendMarkupEscapedScalar(std::string& out, const std::string_view text)
+	{
+		for(const char c : text)
+		{
+			if(c == '&')
+				out += "&amp;";
+			else if(c == '<')
+				out += "&lt;";
+			else if(c == '>')
+				out += "&gt;";
+			else
+				out += c;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] std::size_t FindFirstNonASCIIScalar(const std::string_view text, const std::size_t pos)
+	{
+		for(std::size_t i = pos; i < text.size(); ++i)
+		{
+			if(static_cast<unsigned char>(text[i]) >= 0x80)
+				return i;
+		}
+
+		return std::string_view::npos;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Compare every vectorised scan with its scalar version on the given text.
+	/// </summary>
+	/// <returns>Whether all of them gave the same result.</returns>
+	[[nodiscard]] bool CheckText(const std::string_view text)
+	{
+		bool passed = true;
+		const auto check = [&passed, text](const bool equal, const char* const name)
+		{
+			if(equal)
+				return;
+
+			std::cerr << "  " << name << " differs for a text of " << text.size() << " bytes:";
+			for(const char c : text)
+				std::cerr << ' ' << static_cast<uint32_t>(static_cast<unsigned char>(c));
+			std::cerr << '\n';
+			passed = false;
+		};
+
+		for(std::size_t pos = 0; pos <= text.size(); pos += 7)
+		{
+			check(MD::Detail::FindFirstOf(text, FilenameCharacters, pos) == text.find_first_of(FilenameCharacters, pos), "FindFirstOf");
+			check(MD::Detail::FindFirstOf(text, "&<>", pos) == text.find_first_of("&<>", pos), "FindFirstOf");
+			check(MD::Detail::FindFirstNonASCII(text, pos) == FindFirstNonASCIIScalar(text, pos), "FindFirstNonASCII");
+		}
+
+		std::string vectorised = "prefix";
+		std::string scalar = "prefix";
+		MD::Detail::AppendPythonEscaped(vectorised, text);
+		AppendPythonEscapedScalar(scalar, text);
+		check(vectorised == scalar, "AppendPythonEscaped");
+
+		vectorised = "prefix";
+		scalar = "prefix";
+		MD::Detail::AppendMarkupEscaped(vectorised, text);
+		AppendMarkupEscapedScalar(scalar, text);
+		check(vectorised == scalar, "AppendMarkupEscaped");
+
+		return passed;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+int main()
+{
+	std::cout << "Vectorised scans against their scalar versions for texts of 0 to " << MaxLength << " bytes\n";
+
+	bool passed = true;
+
+	//A single special character at every position, so every lane of every block gets hit
+	for(std::size_t length = 0; length <= MaxLength; ++length)
+	{
+		for(const char special : SpecialCharacters)
+		{
+			for(std::size_t position = 0; position < length; ++position)
+			{
+				std::string text(length, 'a');
+				text[position] = special;
+				passed &= CheckText(text);
+			}
+		}
+	}
+
+	//Fixed seed, so a failure can be reproduced
+	std::mt19937 random(42);
+	std::uniform_int_distribution<uint32_t> byte(0, 255);
+	std::uniform_int_distribution<std::size_t> special(0, SpecialCharacters.size() - 1);
+	for(std::size_t length = 0; length <= MaxLength; ++length)
+	{
+		for(uint32_t i = 0; i < RandomTextsPerLength; ++i)
+		{
+			std::string text(length, '\0');
+			for(char& c : text)
+				c = byte(random) < 32 ? SpecialCharacters[special(random)] : static_cast<char>(byte(random));
+			passed &= CheckText(text);
+		}
+	}
+
+	std::cout << (passed ? "  passed\n" : "  FAILED\n");
+
+	return passed ? 0 : 1;
+}
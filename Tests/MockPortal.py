@@ -0,0 +1,66 @@
+#Mock of the FileChooser portal for PortalTest, owns org.freedesktop.portal.Desktop on the session bus.
+#The title of a dialog selects the answer:
+#  a path starting with '/' is returned as the selected file or folder,
+#  "Cancelled" answers like a dialog closed by the user,
+#  anything else stays open until the Close method of its request is called.
+#Every Close is appended to the log file given as the only argument.
+#Prints "ready" once the name is owned.
+
+import sys
+import urllib.parse
+
+from gi.repository import Gio, GLib
+
+FileChooserXML = '''<node>
+	<interface name="org.freedesktop.portal.FileChooser">
+		<method name="OpenFile"><arg type="s" direction="in"/><arg type="s" direction="in"/><arg type="a{sv}" direction="in"/><arg type="o" direction="out"/></method>
+		<method name="SaveFile"><arg type="s" direction="in"/><arg type="s" direction="in"/><arg type="a{sv}" direction="in"/><arg type="o" direction="out"/></method>
+		<property name="version" type="u" access="read"/>
+	</interface>
+</node>'''
+RequestXML = '''<node><interface name="org.freedesktop.portal.Request"><method name="Close"/></interface></node>'''
+
+FileChooser = Gio.DBusNodeInfo.new_for_xml(FileChooserXML).interfaces[0]
+Request = Gio.DBusNodeInfo.new_for_xml(RequestXML).interfaces[0]
+Log = open(sys.argv[1], 'a', buffering=1)
+RequestCount = 0
+
+def OnFileChooserCall(connection, sender, path, interface, method, parameters, invocation):
+	global RequestCount
+	_, title, _ = parameters.unpack()
+	RequestCount += 1
+	requestPath = '/org/freedesktop/portal/desktop/request/mock/r%d' % RequestCount
+
+	def OnRequestCall(connection, sender, path, interface, method, parameters, requestInvocation):
+		Log.write('Close %s\n' % title)
+		connection.unregister_object(registration)
+		requestInvocation.return_value(None)
+
+	registration = connection.register_object(requestPath, Request, OnRequestCall, None, None)
+	invocation.return_value(GLib.Variant('(o)', (requestPath,)))
+
+	if title.startswith('/'):
+		response = (0, {'uris': GLib.Variant('as', ['file://' + urllib.parse.quote(title)])})
+	elif title == 'Cancelled':
+		response = (1, {})
+	else:
+		return
+
+	def Respond():
+		connection.emit_signal(sender, requestPath, 'org.freedesktop.portal.Request', 'Response', GLib.Variant('(ua{sv})', response))
+		connection.unregister_object(registration)
+		return False
+
+	GLib.idle_add(Respond)
+
+def OnGetProperty(connection, sender, path, interface, name):
+	return GLib.Variant('u', 4)
+
+def OnNameAcquired(connection, name):
+	print('ready', flush=True)
+
+def OnBusAcquired(connection, name):
+	connection.register_object('/org/freedesktop/portal/desktop', FileChooser, OnFileChooserCall, OnGetProperty, None)
+
+Gio.bus_own_name(Gio.BusType.SESSION, 'org.freedesktop.portal.Desktop', Gio.BusNameOwnerFlags.NONE, OnBusAcquired, OnNameAcquired, None)
+GLib.MainLoop().run()
@@ -0,0 +1,223 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <ModernDialogs.h>
+
+#include "Tests.h"
+
+//Runs the file dialogs through the FileChooser portal against Tests/MockPortal.py on a private session bus.
+//Needs dbus-daemon and python3 with PyGObject.
+
+//Path of the mock portal script.
+//premake passes an absolute path, the fallback works when running from the repository root.
+#ifndef MD_TEST_MOCK_PORTAL
+	#define MD_TEST_MOCK_PORTAL "Tests/MockPortal.py"
+#endif
+
+#ifdef __linux__
+namespace
+{
+	//Time a dialog gets to complete, way above what it needs
+	constexpr std::chrono::milliseconds CompletionTimeout{5000};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Helper process started by the test, killed on destruction.
+	/// </summary>
+	class HelperProcess
+	{
+	public:
+		/// <summary>
+		/// Start the given command and wait for the first line it prints.
+		/// </summary>
+		/// <param name="arguments">Command and its arguments, the command is looked up on PATH.</param>
+		explicit HelperProcess(const std::vector<const char*>& arguments)
+		{
+			std::array<int, 2> output{};
+			if(pipe(output.data()) != 0)
+				return;
+
+			std::vector<char*> argv{};
+			for(const char* const argument : arguments)
+				argv.push_back(const_cast<char*>(argument));
+			argv.push_back(nullptr);
+
+			m_pid = fork();
+			if(m_pid == 0)
+			{
+				dup2(output[1], STDOUT_FILENO);
+				close(output[0]);
+				close(output[1]);
+				execvp(argv[0], argv.data());
+				_exit(127);
+			}
+			close(output[1]);
+
+			char c = '\0';
+			pollfd pollFd{output[0], POLLIN, 0};
+			while(m_pid > 0 && poll(&pollFd, 1, static_cast<int>(CompletionTimeout.count())) > 0 && read(output[0], &c, 1) == 1 && c != '\n')
+				m_firstLine.push_back(c);
+			close(output[0]);
+		}
+
+		~HelperProcess()
+		{
+			if(m_pid <= 0)
+				return;
+
+			kill(m_pid, SIGTERM);
+			waitpid(m_pid, nullptr, 0);
+		}
+
+		HelperProcess(const HelperProcess&) = delete;
+		HelperProcess& operator=(const HelperProcess&) = delete;
+
+		/// <returns>First line printed by the process, empty if it didn't start or print anything.</returns>
+		[[nodiscard]] const std::string& GetFirstLine() const
+		{
+			return m_firstLine;
+		}
+
+	private:
+		pid_t m_pid = -1;
+		std::string m_firstLine{};
+	};
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool Check(const bool passed, const char* const name)
+	{
+		std::cout << "  " << name << (passed ? " passed\n" : " FAILED\n");
+
+		return passed;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] std::string ReadFile(const std::string& path)
+	{
+		std::ifstream file(path);
+
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	/// <summary>
+	/// Start a private session bus with the mock portal on it and run the dialogs against it.
+	/// </summary>
+	/// <returns>Whether every dialog got the answer of the mock portal.</returns>
+	[[nodiscard]] bool RunTest()
+	{
+		std::string directory = "/tmp/ModernDialogsPortalTestXXXXXX";
+		if(mkdtemp(directory.data()) == nullptr)
+			return false;
+
+		const std::string file = directory + "/Selected file.txt";
+		const std::string closeLog = directory + "/Closed.log";
+		std::ofstream(file).put('\n');
+
+		const HelperProcess bus({"dbus-daemon", "--session", "--nofork", "--print-address=1"});
+		if(bus.GetFirstLine().empty())
+		{
+			std::cerr << "  dbus-daemon didn't start\n";
+			return false;
+		}
+		setenv("DBUS_SESSION_BUS_ADDRESS", bus.GetFirstLine().c_str(), 1);
+
+		const HelperProcess portal({"python3", MD_TEST_MOCK_PORTAL, closeLog.c_str()});
+		if(portal.GetFirstLine() != "ready")
+		{
+			std::cerr << "  " << MD_TEST_MOCK_PORTAL << " didn't start, it needs python3 with PyGObject\n";
+			return false;
+		}
+
+		//The portal is only used on Wayland
+		setenv("WAYLAND_DISPLAY", "wayland-0", 1);
+		unsetenv("DISPLAY");
+
+		bool passed = true;
+
+		const std::vector<std::string> opened = MD::OpenFile(file, "", {}, false);
+		passed &= Check(opened.size() == 1 && opened[0] == file, "OpenFile");
+		passed &= Check(MD::SaveFileAsync(file).get() == file, "SaveFileAsync");
+		passed &= Check(MD::SelectFolder(directory) == directory, "SelectFolder");
+		passed &= Check(MD::SelectFolder("Cancelled").empty(), "SelectFolder cancelled by the user");
+
+		MD::DialogHandle<std::string> handle = MD::LaunchSaveFile("Stays open");
+		passed &= Check(!handle.WaitFor(std::chrono::milliseconds(200)), "LaunchSaveFile stays open");
+		handle.Cancel();
+		passed &= Check(handle.WaitFor(CompletionTimeout) && handle.Get().empty(), "LaunchSaveFile cancelled");
+
+		MD::SetDialogTimeout(std::chrono::milliseconds(200));
+		passed &= Check(MD::OpenFile("Stays open too", "", {}, false).empty(), "OpenFile timed out");
+		MD::SetDialogTimeout(std::chrono::milliseconds(0));
+
+		//The Close calls are sent before the dialogs complete, but the mock may log them a bit later
+		const std::string expectedCloses = "Close Stays open\nClose Stays open too\n";
+		const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + CompletionTimeout;
+		while(ReadFile(closeLog) != expectedCloses && std::chrono::steady_clock::now() < deadline)
+			usleep(10000);
+		passed &= Check(ReadFile(closeLog) == expectedCloses, "Closed dialogs got closed in the portal");
+
+		unlink(closeLog.c_str());
+		unlink(file.c_str());
+		rmdir(directory.c_str());
+
+		return passed;
+	}
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+int main()
+{
+#ifdef __linux__
+	std::cout << "File dialogs through the FileChooser portal with " << MD_TEST_MOCK_PORTAL << '\n';
+
+	return Tests::RunInChild(RunTest) ? 0 : 1;
+#else
+	std::cout << "The FileChooser portal only exists on Linux, skipped\n";
+
+	return 0;
+#endif
+}
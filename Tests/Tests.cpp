@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Tests.h"
+
+//Directory containing one directory of stub executables per backend.
+//premake passes an absolute path, the fallback works when running from the repository root.
+#ifndef MD_TEST_STUBS_DIR
+	#define MD_TEST_STUBS_DIR "Benchmarks/Stubs"
+#endif
+
+bool Tests::UseStubBackend([[maybe_unused]] const char* const backend)
+{
+#ifdef __linux__
+	const std::string path = std::string(MD_TEST_STUBS_DIR) + '/' + backend;
+	if(access(path.c_str(), X_OK) != 0)
+	{
+		std::cerr << "Stub backend directory " << path << " not found\n";
+		return false;
+	}
+
+	setenv("PATH", path.c_str(), 1);
+	setenv("DISPLAY", ":0", 1);
+	unsetenv("WAYLAND_DISPLAY");
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+bool Tests::IsSelectionOf(const MD::Buttons buttons, const MD::Selection selection)
+{
+	switch(buttons)
+	{
+	case MD::Buttons::OK:
+		return selection == MD::Selection::OK;
+
+	case MD::Buttons::OKCancel:
+		return selection == MD::Selection::OK || selection == MD::Selection::Cancel;
+
+	case MD::Buttons::YesNo:
+		return selection == MD::Selection::Yes || selection == MD::Selection::No;
+
+	case MD::Buttons::Quit:
+		return selection == MD::Selection::Quit;
+	}
+
+	return false;
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+bool Tests::RunInChild([[maybe_unused]] const std::function<bool()>& func)
+{
+#ifdef __linux__
+	//Children must not inherit pending output
+	std::cout.flush();
+	std::cerr.flush();
+
+	const pid_t pid = fork();
+	if(pid < 0)
+		return false;
+
+	if(pid == 0)
+		std::exit(func() ? 0 : 1); //Run static destructors, so background threads of the library get joined
+
+	int status = 0;
+	if(waitpid(pid, &status, 0) != pid)
+		return false;
+
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _GAMESTRAP_MODERNDIALOGS_TESTS_H_
+#define _GAMESTRAP_MODERNDIALOGS_TESTS_H_
+
+#include <array>
+#include <functional>
+
+#include <ModernDialogs.h>
+
+namespace Tests
+{
+	//Each backend has a directory with its stubs below MD_TEST_STUBS_DIR, which becomes the only entry on PATH
+	inline constexpr std::array<const char*, 7> StubBackends
+	{
+		"kdialog", "zenity", "matedialog", "shellementary", "qarma", "yad", "tkinter"
+	};
+
+	//Zenity stub whose message boxes stay open until they get cancelled, file dialogs are answered right away
+	inline constexpr const char* BlockingStubBackend = "blocking";
+
+	/// <summary>
+	/// Make the stubs of the given backend the only executables the library can find.
+	/// </summary>
+	/// <param name="backend">Name of the backend, one of StubBackends or BlockingStubBackend.</param>
+	/// <returns>Whether the stubs of the backend exist.</returns>
+	[[nodiscard]] bool UseStubBackend(const char* backend);
+
+	/// <summary>
+	/// Check whether a message box answered by a stub returned one of the given buttons.
+	/// </summary>
+	/// <param name="buttons">Buttons of the message box.</param>
+	/// <param name="selection">Selection returned by the message box.</param>
+	/// <returns>Whether selection belongs to buttons.</returns>
+	[[nodiscard]] bool IsSelectionOf(MD::Buttons buttons, MD::Selection selection);
+
+	/// <summary>
+	/// Run func in a freshly forked child process, so every run starts with cold library state.<br>
+	/// Always fails on platforms without fork().
+	/// </summary>
+	/// <param name="func">Test to run inside the child process.</param>
+	/// <returns>Whether func returned true and the child exited normally.</returns>
+	[[nodiscard]] bool RunInChild(const std::function<bool()>& func);
+}
+
+#endif /*_GAMESTRAP_MODERNDIALOGS_TESTS_H_*/
@@ -0,0 +1,153 @@
+/*
+MIT License
+
+Copyright (c) 2020 - 2025 Jan "GamesTrap" Schürkamp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <ModernDialogsDetail.h>
+
+//Checks the UTF-8 validation and sanitization against known inputs.
+//Every maximal ill-formed subsequence has to become a single U+FFFD, as described in section 3.9 of the Unicode standard.
+
+namespace
+{
+	//Replacement character U+FFFD
+	#define FFFD "\xEF\xBF\xBD"
+
+	struct UTF8Case
+	{
+		const char* Name;
+		std::string_view Input;
+		//Index of the first invalid byte or std::string_view::npos
+		std::size_t FirstInvalid;
+		std::string_view Sanitized;
+	};
+
+	constexpr std::size_t Valid = std::string_view::npos;
+
+	//Long enough for the vectorised ASCII scan to skip whole blocks before the interesting bytes
+	#define ASCII40 "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+
+	const std::array<UTF8Case, 36> Cases
+	{{
+		{"empty", "", Valid, ""},
+		{"ASCII", "Report.pdf", Valid, "Report.pdf"},
+		{"2 byte sequence", "caf\xC3\xA9", Valid, "caf\xC3\xA9"},
+		{"3 byte sequence", "\xE2\x82\xAC", Valid, "\xE2\x82\xAC"},
+		{"4 byte sequence", "\xF0\x9F\x98\x80", Valid, "\xF0\x9F\x98\x80"},
+		{"U+FFFD itself", FFFD, Valid, FFFD},
+		{"last code point U+10FFFF", "\xF4\x8F\xBF\xBF", Valid, "\xF4\x8F\xBF\xBF"},
+		{"last code point before the surrogates U+D7FF", "\xED\x9F\xBF", Valid, "\xED\x9F\xBF"},
+		{"first code point after the surrogates U+E000", "\xEE\x80\x80", Valid, "\xEE\x80\x80"},
+		{"smallest 3 byte form U+0800", "\xE0\xA0\x80", Valid, "\xE0\xA0\x80"},
+		{"smallest 4 byte form U+10000", "\xF0\x90\x80\x80", Valid, "\xF0\x90\x80\x80"},
+		{"valid after an ASCII run", ASCII40 "\xC3\xA9" ASCII40, Valid, ASCII40 "\xC3\xA9" ASCII40},
+
+		{"overlong 2 byte form C0", "\xC0\xAF", 0, FFFD FFFD},
+		{"overlong 2 byte form C1", "\xC1\xBF", 0, FFFD FFFD},
+		{"overlong 3 byte form", "\xE0\x80\xAF", 0, FFFD FFFD FFFD},
+		{"overlong 3 byte form of U+07FF", "\xE0\x9F\xBF", 0, FFFD FFFD FFFD},
+		{"overlong 4 byte form", "\xF0\x80\x80\xAF", 0, FFFD FFFD FFFD FFFD},
+		{"overlong 4 byte form of U+FFFF", "\xF0\x8F\xBF\xBF", 0, FFFD FFFD FFFD FFFD},
+		{"first surrogate U+D800", "\xED\xA0\x80", 0, FFFD FFFD FFFD},
+		{"last surrogate U+DFFF", "\xED\xBF\xBF", 0, FFFD FFFD FFFD},
+		{"first code point above U+10FFFF", "\xF4\x90\x80\x80", 0, FFFD FFFD FFFD FFFD},
+		{"lead byte F5", "\xF5\x80\x80\x80", 0, FFFD FFFD FFFD FFFD},
+		{"5 byte form", "\xF8\x88\x80\x80\x80", 0, FFFD FFFD FFFD FFFD FFFD},
+		{"bytes FE and FF", "\xFE\xFF", 0, FFFD FFFD},
+		{"lone continuation bytes", "a\x80\xBF" "b", 1, "a" FFFD FFFD "b"},
+		{"continuation byte after a sequence", "\xF0\x9F\x98\x80\x80", 4, "\xF0\x9F\x98\x80" FFFD},
+
+		{"truncated 2 byte sequence at the end", "a\xC3", 1, "a" FFFD},
+		{"truncated 3 byte sequence at the end", "a\xE2\x82", 1, "a" FFFD},
+		{"truncated 4 byte sequence at the end", "a\xF0\x9F\x98", 1, "a" FFFD},
+		{"truncated 3 byte sequence before ASCII", "\xE2\x82" "a", 0, FFFD "a"},
+		{"truncated 4 byte sequence before a sequence", "\xF0\x9F\xC3\xA9", 0, FFFD "\xC3\xA9"},
+		{"truncated surrogate", "\xED\xA0", 0, FFFD FFFD},
+		{"invalid after an ASCII run", ASCII40 "\xC3(", 40, ASCII40 FFFD "("},
+		{"truncated at the end after an ASCII run", ASCII40 "\xE2\x82", 40, ASCII40 FFFD},
+
+		//Example of table 3-8 of the Unicode standard
+		{"table 3-8", "a\xF1\x80\x80\xE1\x80\xC2" "b\x80" "c\x80\xBF" "d", 1, "a" FFFD FFFD FFFD "b" FFFD "c" FFFD FFFD "d"},
+		{"table 3-8 without the ASCII", "\xF1\x80\x80\xE1\x80\xC2", 0, FFFD FFFD FFFD}
+	}};
+
+	#undef ASCII40
+	#undef FFFD
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	void PrintBytes(const std::string_view text)
+	{
+		for(const char c : text)
+			std::cerr << ' ' << std::hex << static_cast<uint32_t>(static_cast<unsigned char>(c)) << std::dec;
+	}
+
+	//-------------------------------------------------------------------------------------------------------------------//
+
+	[[nodiscard]] bool CheckCase(const UTF8Case& utf8Case)
+	{
+		const std::size_t firstInvalid = MD::Detail::FindInvalidUTF8(utf8Case.Input);
+
+		std::string sanitized = "prefix";
+		MD::Detail::AppendSanitizedUTF8(sanitized, utf8Case.Input);
+		const bool sanitizedMatches = std::string_view(sanitized).substr(6) == utf8Case.Sanitized && sanitized.compare(0, 6, "prefix") == 0;
+
+		if(firstInvalid == utf8Case.FirstInvalid && sanitizedMatches)
+			return true;
+
+		std::cerr << "  " << utf8Case.Name << " FAILED\n    FindInvalidUTF8() returned ";
+		if(firstInvalid == Valid)
+			std::cerr << "npos";
+		else
+			std::cerr << firstInvalid;
+		std::cerr << "\n    AppendSanitizedUTF8() appended";
+		PrintBytes(std::string_view(sanitized).substr(6));
+		std::cerr << '\n';
+
+		return false;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------//
+
+int main()
+{
+	std::cout << "UTF-8 validation and sanitization of " << Cases.size() << " known inputs\n";
+
+	bool passed = true;
+	for(const UTF8Case& utf8Case : Cases)
+		passed &= CheckCase(utf8Case);
+
+	//The validation may also continue at the start of a later sequence
+	passed &= MD::Detail::FindInvalidUTF8("\xC0" "a\xC3\xA9", 1) == Valid;
+	passed &= MD::Detail::FindInvalidUTF8("a\xC3\xA9\xC0", 1) == 3;
+
+	std::cout << (passed ? "  passed\n" : "  FAILED\n");
+
+	return passed ? 0 : 1;
+}
@@ -91,10 +91,306 @@ project "Example"
 		"ModernDialogs"
 	}
 
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
+	filter "configurations:Debug*"
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release*"
+		runtime "Release"
+		optimize "On"
+
+project "Benchmarks"
+	location "Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "off"
+	cppdialect "C++17"
+	systemversion "latest"
+	warnings "Extra"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+
+	--Add all source and header files
+	files
+	{
+		"Benchmarks/**.h",
+		"Benchmarks/**.cpp"
+	}
+
+	includedirs
+	{
+		"ModernDialogs/"
+	}
+
+	links
+	{
+		"ModernDialogs"
+	}
+
+	defines
+	{
+		"MD_BENCHMARK_STUBS_DIR=\"%{wks.location}/Benchmarks/Stubs\""
+	}
+
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
+	filter "configurations:Debug*"
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release*"
+		runtime "Release"
+		optimize "On"
+
+project "AllocationTest"
+	location "Tests"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "off"
+	cppdialect "C++17"
+	systemversion "latest"
+	warnings "Extra"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+
+	files
+	{
+		"Tests/Tests.h",
+		"Tests/Tests.cpp",
+		"Tests/AllocationTest.cpp"
+	}
+
+	includedirs
+	{
+		"ModernDialogs/"
+	}
+
+	links
+	{
+		"ModernDialogs"
+	}
+
+	defines
+	{
+		"MD_TEST_STUBS_DIR=\"%{wks.location}/Benchmarks/Stubs\""
+	}
+
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
 	filter "configurations:Debug*"
 		runtime "Debug"
 		symbols "On"
 
 	filter "configurations:Release*"
 		runtime "Release"
-		optimize "On"
\ No newline at end of file
+		optimize "On"
+
+project "EscapingTest"
+	location "Tests"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "off"
+	cppdialect "C++17"
+	systemversion "latest"
+	warnings "Extra"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+
+	files
+	{
+		"Tests/EscapingTest.cpp"
+	}
+
+	includedirs
+	{
+		"ModernDialogs/"
+	}
+
+	links
+	{
+		"ModernDialogs"
+	}
+
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
+	filter "configurations:Debug*"
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release*"
+		runtime "Release"
+		optimize "On"
+
+project "UTF8Test"
+	location "Tests"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "off"
+	cppdialect "C++17"
+	systemversion "latest"
+	warnings "Extra"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+
+	files
+	{
+		"Tests/UTF8Test.cpp"
+	}
+
+	includedirs
+	{
+		"ModernDialogs/"
+	}
+
+	links
+	{
+		"ModernDialogs"
+	}
+
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
+	filter "configurations:Debug*"
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release*"
+		runtime "Release"
+		optimize "On"
+
+project "PortalTest"
+	location "Tests"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "off"
+	cppdialect "C++17"
+	systemversion "latest"
+	warnings "Extra"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+
+	files
+	{
+		"Tests/Tests.h",
+		"Tests/Tests.cpp",
+		"Tests/PortalTest.cpp"
+	}
+
+	includedirs
+	{
+		"ModernDialogs/"
+	}
+
+	links
+	{
+		"ModernDialogs"
+	}
+
+	defines
+	{
+		"MD_TEST_MOCK_PORTAL=\"%{wks.location}/Tests/MockPortal.py\""
+	}
+
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
+	filter "configurations:Debug*"
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release*"
+		runtime "Release"
+		optimize "On"
+
+project "ConcurrencyTest"
+	location "Tests"
+	kind "ConsoleApp"
+	language "C++"
+	staticruntime "off"
+	cppdialect "C++17"
+	systemversion "latest"
+	warnings "Extra"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.group}/%{prj.name}")
+
+	--The library is compiled into the test, so ThreadSanitizer instruments it too
+	files
+	{
+		"Tests/Tests.h",
+		"Tests/Tests.cpp",
+		"Tests/ConcurrencyTest.cpp",
+		"ModernDialogs/**.h",
+		"ModernDialogs/**.cpp"
+	}
+
+	includedirs
+	{
+		"ModernDialogs/"
+	}
+
+	defines
+	{
+		"MD_TEST_STUBS_DIR=\"%{wks.location}/Benchmarks/Stubs\""
+	}
+
+	filter "system:linux"
+		links
+		{
+			"pthread",
+			"dl"
+		}
+
+	--ThreadSanitizer only supports 64-bit targets
+	filter { "system:linux", "platforms:x86_64" }
+		buildoptions
+		{
+			"-fsanitize=thread"
+		}
+		linkoptions
+		{
+			"-fsanitize=thread"
+		}
+
+	filter "configurations:Debug*"
+		runtime "Debug"
+		symbols "On"
+
+	filter "configurations:Release*"
+		runtime "Release"
+		optimize "On"